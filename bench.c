@@ -0,0 +1,721 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "compress_and_decompress.h"
+#include "decode_table.h"
+#include "huffman_arena.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BENCH_HAVE_TSC 1
+#include <x86intrin.h>
+#endif
+
+/*****************************************************************************
+**
+* Filename: bench.c
+*
+* Description:
+* Reproducible benchmark suite. Generates deterministic synthetic corpora
+* (uniform random, Zipf-skewed, a single repeated symbol, text-like, and
+* already-compressed data) or takes the files named on the command line,
+* and times every stage of the pipeline on each: countFrequencies,
+* buildHuffmanTree, HuffmanCodes, compress, and the table-driven,
+* tree-walk and interleaved multi-stream (BENCH_STREAMS streams) decoders.
+* Each stage runs a number of untimed warmup passes and then a number of
+* timed repetitions; the median and 99th percentile time, MB/s and bytes
+* per cycle are reported, and with -j the results are also written as
+* JSON so runs can be compared across releases. Every decoder's output is
+* checked against the input. A last section times the tree build over
+* alphabets of 256 to 64K symbols for the sorted linked-list Queue, the
+* MinHeap, the two-queue method on sorted leaves, and the allocation-free
+* HuffmanArena (reused across repetitions).
+*
+* Cycles are read from the time-stamp counter on x86, which ticks at the
+* nominal frequency; elsewhere bytes per cycle is reported as 0.
+*
+* Dependencies:
+* stdio.h
+* stdlib.h
+* string.h
+* time.h
+* x86intrin.h (x86 only)
+* compress_and_decompress.h
+* decode_table.h
+* huffman_arena.h
+*
+* Compilation:
+* gcc -O2 compress_and_decompress.c priority_queue.c histogram.c file_input.c bit_io.c decode_table.c canonical.c huffman_arena.c bench.c -o bench
+* ./bench [-s corpusSize] [-w warmup] [-r repetitions] [-j results.json] [FileName.txt ...]
+*****************************************************************************/
+
+#define BENCH_CORPUS_SIZE (4u << 20)
+#define BENCH_WARMUP 2
+#define BENCH_REPETITIONS 11
+#define BENCH_STREAMS 4
+#define BENCH_MAX_CORPORA 16
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t nowCycles(void) {
+#ifdef BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// xorshift32: the same seed gives the same corpus on every machine
+static uint32_t nextRandom(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void fillUniform(unsigned char *data, size_t size) {
+    uint32_t state = 0x9E3779B9u;
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (unsigned char)(nextRandom(&state) >> 24);
+    }
+}
+
+// Byte values ranked in a shuffled order, the value of rank r drawn with probability proportional to 1 / (r + 1)
+static void fillZipf(unsigned char *data, size_t size) {
+    uint32_t state = 2463534242u;
+    unsigned char symbols[256];
+    double cumulative[256];
+    double total = 0;
+    for (int rank = 0; rank < 256; rank++) {
+        symbols[rank] = (unsigned char)rank;
+        total += 1.0 / (rank + 1);
+        cumulative[rank] = total;
+    }
+    for (int i = 255; i > 0; i--) {
+        int j = (int)(nextRandom(&state) % (uint32_t)(i + 1));
+        unsigned char swap = symbols[i];
+        symbols[i] = symbols[j];
+        symbols[j] = swap;
+    }
+    for (size_t i = 0; i < size; i++) {
+        double target = (double)nextRandom(&state) / 4294967296.0 * total;
+        int low = 0;
+        int high = 255;
+        while (low < high) {
+            int middle = (low + high) / 2;
+            if (cumulative[middle] < target) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        data[i] = symbols[low];
+    }
+}
+
+// The case HuffmanCodes() gives a 1-bit code
+static void fillSingle(unsigned char *data, size_t size) {
+    memset(data, 'a', size);
+}
+
+// A skewed, text-like byte distribution
+static void fillText(unsigned char *data, size_t size) {
+    static const char common[] = "eeeeeeetttttaaaaooooiiiinnnnssshhhrrrddllcuumwfgypbvk       \n";
+    uint32_t state = 12345;
+    for (size_t i = 0; i < size; i++) {
+        state = state * 1103515245u + 12345u;
+        unsigned r = (state >> 16) & 0x7FFF;
+        // Mostly common letters, with a long tail over the whole byte range
+        data[i] = (unsigned char)((r % 16 != 0) ? common[r % (sizeof common - 1)] : (int)(r % 256));
+    }
+}
+
+// Huffman-coded text: what a second pass over already-compressed data sees
+static void fillCompressed(unsigned char *data, size_t size) {
+    size_t textSize = size * 2;
+    unsigned char *text = malloc(textSize);
+    unsigned char *packed = malloc(textSize);
+    static char codes[256][MAX];
+    node_t nodes[256];
+    int uniqueCount = 0;
+    if (text == NULL || packed == NULL) {
+        free(text);
+        free(packed);
+        fillUniform(data, size);
+        return;
+    }
+    fillText(text, textSize);
+    countBufferFrequencies(text, textSize, nodes, &uniqueCount);
+    MinHeap heap;
+    HuffmanNode *root = NULL;
+    if (initHeap(&heap, uniqueCount) == 0) {
+        for (int i = 0; i < uniqueCount; i++) {
+            HuffmanNode *leaf = createLeafNode((char)nodes[i].index, nodes[i].weight);
+            if (leaf == NULL) {
+                break;
+            }
+            heapPush(&heap, leaf);
+        }
+        if (heap.size == uniqueCount) {
+            root = buildHuffmanTreeHeap(&heap);
+        }
+        while (heap.size > 0) {
+            free(heapPop(&heap)); // Only leaves are left when a leaf allocation failed
+        }
+        freeHeap(&heap);
+    }
+    if (root == NULL) {
+        free(text);
+        free(packed);
+        fillUniform(data, size);
+        return;
+    }
+    HuffmanCodes(root, codes);
+    // The text averages over 4 bits per byte, so twice `size` bytes of it packs into at least `size` bytes
+    compressBuffer(text, textSize, packed, codes);
+    memcpy(data, packed, size);
+    freeHuffmanTree(root);
+    free(text);
+    free(packed);
+}
+
+typedef struct {
+    const char *name;
+    void (*fill)(unsigned char *data, size_t size);
+} CorpusGenerator;
+
+static const CorpusGenerator generators[] = {
+    {"uniform", fillUniform},
+    {"zipf", fillZipf},
+    {"single", fillSingle},
+    {"text", fillText},
+    {"compressed", fillCompressed},
+};
+
+// Generates a corpus into `filename`, since countFrequencies() and compress() read their input from a file
+static int writeCorpus(const CorpusGenerator *generator, const char *filename, size_t size) {
+    unsigned char *data = malloc(size);
+    FILE *file = fopen(filename, "wb");
+    if (data == NULL || file == NULL) {
+        fprintf(stderr, "Error: Unable to create file '%s'\n", filename);
+        free(data);
+        if (file != NULL) {
+            fclose(file);
+        }
+        return -1;
+    }
+    generator->fill(data, size);
+    int status = fwrite(data, 1, size, file) == size ? 0 : -1;
+    if (fclose(file) != 0 || status != 0) {
+        fprintf(stderr, "Error: Unable to write file '%s'\n", filename);
+        status = -1;
+    }
+    free(data);
+    return status;
+}
+
+static long readAll(const char *filename, char **data) {
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Unable to open file '%s'\n", filename);
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    *data = malloc((size_t)size + 1);
+    if (*data == NULL || fread(*data, 1, (size_t)size, file) != (size_t)size) {
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+    return size;
+}
+
+/*****************************************************************************
+**
+* Structure: BenchCorpus
+*
+* Fields:
+* name (const char*) - Corpus name in the report.
+* filename (const char*) - File holding the corpus.
+* original (char*) - The corpus in memory, to check decoded output against.
+* size (size_t) - Bytes in the corpus.
+* nodes, uniqueCount - countFrequencies() output.
+* queue (Queue) - Leaves for buildHuffmanTree(), refilled before every run.
+* root (HuffmanNode*) - buildHuffmanTree() output.
+* codes (char (*)[MAX]) - HuffmanCodes() output.
+* compressed (unsigned char*) - compress() output; compressStreams() uses `streamed`.
+* bits (uint64_t) - Bits written by compress().
+* streamed (unsigned char*) - compressStreams() output.
+* streamBits (uint64_t[]) - Bits in each of compressStreams()' streams.
+* decompressed (char*) - Decoder output.
+* decoded (size_t) - Bytes the last decoder produced, or 0 if it failed.
+*****************************************************************************/
+typedef struct {
+    const char *name;
+    const char *filename;
+    char *original;
+    size_t size;
+    node_t nodes[256];
+    int uniqueCount;
+    Queue queue;
+    HuffmanNode *root;
+    char (*codes)[MAX];
+    unsigned char *compressed;
+    uint64_t bits;
+    unsigned char *streamed;
+    uint64_t streamBits[BENCH_STREAMS];
+    char *decompressed;
+    size_t decoded;
+} BenchCorpus;
+
+static int runCount(BenchCorpus *corpus) {
+    return countFrequencies(corpus->filename, corpus->nodes, &corpus->uniqueCount);
+}
+
+// buildHuffmanTree() consumes its queue, so every run starts from a fresh one
+static int prepareBuild(BenchCorpus *corpus) {
+    freeHuffmanTree(corpus->root);
+    corpus->root = NULL;
+    initQueue(&corpus->queue);
+    for (int i = 0; i < corpus->uniqueCount; i++) {
+        HuffmanNode *leaf = createLeafNode((char)corpus->nodes[i].index, corpus->nodes[i].weight);
+        if (leaf == NULL || priorityEnqueue(&corpus->queue, leaf) != 0) {
+            free(leaf);
+            HuffmanNode *queued;
+            while ((queued = priorityDequeue(&corpus->queue)) != NULL) {
+                free(queued);
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int runBuild(BenchCorpus *corpus) {
+    corpus->root = buildHuffmanTree(&corpus->queue);
+    return corpus->root != NULL ? 0 : -1;
+}
+
+static int runCodes(BenchCorpus *corpus) {
+    HuffmanCodes(corpus->root, corpus->codes);
+    return 0;
+}
+
+static int runCompress(BenchCorpus *corpus) {
+    corpus->bits = compress(corpus->filename, corpus->compressed, corpus->root, corpus->codes);
+    return corpus->bits != HUF_COMPRESS_ERROR ? 0 : -1;
+}
+
+// The decoders always return 0: a short or wrong output is a mismatch, which timeStage() reports
+static int runDecompress(BenchCorpus *corpus) {
+    corpus->decoded = decompress(corpus->compressed, corpus->bits, corpus->decompressed, corpus->size + 8, corpus->root);
+    return 0;
+}
+
+static int runTreeWalk(BenchCorpus *corpus) {
+    corpus->decoded = decompressTreeWalk(corpus->compressed, corpus->bits, corpus->decompressed, corpus->size + 8,
+                                         corpus->root);
+    return 0;
+}
+
+static int runCompressStreams(BenchCorpus *corpus) {
+    size_t size = 0;
+    return compressStreams(corpus->filename, corpus->streamed, corpus->codes, BENCH_STREAMS, corpus->streamBits, &size) > 0
+               ? 0
+               : -1;
+}
+
+static int runDecompressStreams(BenchCorpus *corpus) {
+    int status = decompressStreams(corpus->streamed, corpus->streamBits, BENCH_STREAMS, corpus->decompressed,
+                                   corpus->size, corpus->root);
+    corpus->decoded = status == 0 ? corpus->size : 0;
+    return 0;
+}
+
+/*****************************************************************************
+**
+* Structure: BenchStage
+*
+* Fields:
+* name (const char*) - Stage name in the report.
+* prepare (int (*)(BenchCorpus*)) - Untimed setup before every run, or NULL. Returns 0, or -1 on failure.
+* run (int (*)(BenchCorpus*)) - The timed work. Returns 0, or -1 if the stage failed and later stages cannot run.
+* decodes (int) - Set for decoders, whose output is checked against the corpus.
+*****************************************************************************/
+typedef struct {
+    const char *name;
+    int (*prepare)(BenchCorpus *corpus);
+    int (*run)(BenchCorpus *corpus);
+    int decodes;
+} BenchStage;
+
+// In pipeline order: each stage uses what the stages before it left in the corpus
+static const BenchStage stages[] = {
+    {"countFrequencies", NULL, runCount, 0},
+    {"buildHuffmanTree", prepareBuild, runBuild, 0},
+    {"HuffmanCodes", NULL, runCodes, 0},
+    {"compress", NULL, runCompress, 0},
+    {"decompress", NULL, runDecompress, 1},
+    {"decompressTreeWalk", NULL, runTreeWalk, 1},
+    {"compressStreams", NULL, runCompressStreams, 0},
+    {"decompressStreams", NULL, runDecompressStreams, 1},
+};
+#define BENCH_STAGE_COUNT (sizeof stages / sizeof stages[0])
+
+/*****************************************************************************
+**
+* Structure: StageResult
+*
+* Fields:
+* median, p99 (double) - Median and 99th percentile (nearest rank) time of one run, in seconds.
+* megabytesPerSecond (double) - Corpus size over the median time.
+* bytesPerCycle (double) - Corpus size over the median cycle count (0 without a cycle counter).
+* ok (int) - Cleared when a decoder's output does not match the corpus.
+*****************************************************************************/
+typedef struct {
+    double median;
+    double p99;
+    double megabytesPerSecond;
+    double bytesPerCycle;
+    int ok;
+} StageResult;
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Sorts `samples` and returns the value at `fraction` of the way through, by nearest rank
+static double percentile(double samples[], int count, double fraction) {
+    qsort(samples, (size_t)count, sizeof(double), compareDoubles);
+    int rank = (int)(fraction * count + 0.999999);
+    return samples[rank < 1 ? 0 : rank - 1];
+}
+
+// Fills in `result` and returns 0, or returns -1 if the stage's setup or a run fails
+static int timeStage(const BenchStage *stage, BenchCorpus *corpus, int warmup, int repetitions, StageResult *result) {
+    StageResult timed = {0, 0, 0, 0, 1};
+    double *times = malloc((size_t)repetitions * sizeof(double));
+    double *cycles = malloc((size_t)repetitions * sizeof(double));
+    if (times == NULL || cycles == NULL) {
+        free(times);
+        free(cycles);
+        return -1;
+    }
+    for (int rep = 0; rep < warmup + repetitions; rep++) {
+        if (stage->prepare != NULL && stage->prepare(corpus) != 0) {
+            free(times);
+            free(cycles);
+            return -1;
+        }
+        double start = nowSeconds();
+        uint64_t startCycles = nowCycles();
+        int status = stage->run(corpus);
+        uint64_t endCycles = nowCycles();
+        double elapsed = nowSeconds() - start;
+        if (status != 0) {
+            free(times);
+            free(cycles);
+            return -1;
+        }
+        if (rep >= warmup) {
+            times[rep - warmup] = elapsed;
+            cycles[rep - warmup] = (double)(endCycles - startCycles);
+        }
+        if (stage->decodes) {
+            timed.ok &= corpus->decoded == corpus->size && memcmp(corpus->decompressed, corpus->original, corpus->size) == 0;
+            memset(corpus->decompressed, 0, corpus->size);
+        }
+    }
+    timed.median = percentile(times, repetitions, 0.5);
+    timed.p99 = percentile(times, repetitions, 0.99);
+    double medianCycles = percentile(cycles, repetitions, 0.5);
+    timed.megabytesPerSecond = timed.median > 0 ? (double)corpus->size / timed.median / 1e6 : 0;
+    timed.bytesPerCycle = medianCycles > 0 ? (double)corpus->size / medianCycles : 0;
+    free(times);
+    free(cycles);
+    *result = timed;
+    return 0;
+}
+
+static void freeCorpus(BenchCorpus *corpus) {
+    freeHuffmanTree(corpus->root);
+    free(corpus->original);
+    free(corpus->compressed);
+    free(corpus->streamed);
+    free(corpus->decompressed);
+}
+
+// Runs every stage on one corpus, printing a table and (if `json` is set) appending a JSON object, after which `first`
+// is cleared. A stage that fails ends the corpus run before anything is reported.
+static int benchCorpus(BenchCorpus *corpus, int warmup, int repetitions, FILE *json, int *first) {
+    static char codes[256][MAX];
+    long size = readAll(corpus->filename, &corpus->original);
+    if (size <= 0) {
+        fprintf(stderr, "Error: Nothing to benchmark in '%s'\n", corpus->filename);
+        free(corpus->original);
+        return -1;
+    }
+    corpus->size = (size_t)size;
+    corpus->codes = codes;
+    corpus->root = NULL;
+    // Codes are at most 255 bits, so the worst case is 32 output bytes per input byte
+    corpus->compressed = malloc(corpus->size * 32 + 8);
+    corpus->streamed = malloc(corpus->size * 32 + 8 * BENCH_STREAMS);
+    corpus->decompressed = calloc(corpus->size + 8, 1);
+    if (corpus->compressed == NULL || corpus->streamed == NULL || corpus->decompressed == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        freeCorpus(corpus);
+        return -1;
+    }
+
+    StageResult results[BENCH_STAGE_COUNT];
+    int ok = 1;
+    for (size_t i = 0; i < BENCH_STAGE_COUNT; i++) {
+        if (timeStage(&stages[i], corpus, warmup, repetitions, &results[i]) != 0) {
+            fprintf(stderr, "Error: %s failed on '%s'\n", stages[i].name, corpus->filename);
+            freeCorpus(corpus);
+            return -1;
+        }
+        ok &= results[i].ok;
+    }
+    double bitsPerByte = (double)corpus->bits / (double)corpus->size;
+
+    printf("\n%s: %zu bytes, %d distinct, %.3f bits/byte\n", corpus->name, corpus->size, corpus->uniqueCount, bitsPerByte);
+    printf("%-20s %10s %10s %10s %10s\n", "stage", "median ms", "p99 ms", "MB/s", "B/cycle");
+    for (size_t i = 0; i < BENCH_STAGE_COUNT; i++) {
+        printf("%-20s %10.3f %10.3f %10.1f %10.3f%s\n", stages[i].name, results[i].median * 1e3, results[i].p99 * 1e3,
+               results[i].megabytesPerSecond, results[i].bytesPerCycle, results[i].ok ? "" : " MISMATCH");
+    }
+
+    if (json != NULL) {
+        fprintf(json, "%s\n    {\"name\": \"%s\", \"size\": %zu, \"distinctBytes\": %d, \"compressedBytes\": %llu, "
+                      "\"bitsPerByte\": %.4f, \"ok\": %s, \"stages\": [",
+                *first ? "" : ",", corpus->name, corpus->size, corpus->uniqueCount,
+                (unsigned long long)((corpus->bits + 7) / 8), bitsPerByte, ok ? "true" : "false");
+        for (size_t i = 0; i < BENCH_STAGE_COUNT; i++) {
+            fprintf(json, "%s\n      {\"name\": \"%s\", \"medianMs\": %.6f, \"p99Ms\": %.6f, \"mbPerSecond\": %.3f, "
+                          "\"bytesPerCycle\": %.4f, \"ok\": %s}",
+                    i == 0 ? "" : ",", stages[i].name, results[i].median * 1e3, results[i].p99 * 1e3,
+                    results[i].megabytesPerSecond, results[i].bytesPerCycle, results[i].ok ? "true" : "false");
+        }
+        fprintf(json, "\n    ]}");
+        *first = 0;
+    }
+
+    freeCorpus(corpus);
+    return ok ? 0 : -1;
+}
+
+static int compareLeaves(const void *a, const void *b) {
+    const HuffmanNode *x = *(HuffmanNode *const *)a;
+    const HuffmanNode *y = *(HuffmanNode *const *)b;
+    return (x->frequency > y->frequency) - (x->frequency < y->frequency);
+}
+
+static void freeLeaves(HuffmanNode *leaves[], int count) {
+    for (int i = 0; i < count; i++) {
+        free(leaves[i]);
+    }
+}
+
+// Zipf-like weights over `count` symbols, in a shuffled order. Returns -1, with nothing left allocated, on failure.
+static int makeLeaves(HuffmanNode *leaves[], int count) {
+    uint32_t state = 2463534242u;
+    for (int i = 0; i < count; i++) {
+        leaves[i] = createLeafNode((char)i, 1 + 1000000 / (i + 1));
+        if (leaves[i] == NULL) {
+            freeLeaves(leaves, i);
+            return -1;
+        }
+    }
+    for (int i = count - 1; i > 0; i--) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        int j = (int)(state % (uint32_t)(i + 1));
+        HuffmanNode *swap = leaves[i];
+        leaves[i] = leaves[j];
+        leaves[j] = swap;
+    }
+    return 0;
+}
+
+// Builds one tree from `leaves` with the given method, returning NULL (with the leaves freed) if an allocation fails
+static HuffmanNode *buildWithMethod(int method, HuffmanNode *leaves[], int count) {
+    HuffmanNode *root;
+    if (method == 0) {
+        Queue queue;
+        initQueue(&queue);
+        for (int i = 0; i < count; i++) {
+            if (priorityEnqueue(&queue, leaves[i]) != 0) {
+                freeQueue(&queue);
+                freeLeaves(leaves, count);
+                return NULL;
+            }
+        }
+        root = buildHuffmanTree(&queue);
+    } else if (method == 1) {
+        MinHeap heap;
+        if (initHeap(&heap, count) != 0) {
+            freeLeaves(leaves, count);
+            return NULL;
+        }
+        for (int i = 0; i < count; i++) {
+            heapPush(&heap, leaves[i]);
+        }
+        root = buildHuffmanTreeHeap(&heap);
+        freeHeap(&heap);
+    } else {
+        qsort(leaves, (size_t)count, sizeof(HuffmanNode *), compareLeaves);
+        root = buildHuffmanTreeSorted(leaves, count);
+        if (root == NULL) {
+            freeLeaves(leaves, count);
+        }
+    }
+    return root;
+}
+
+static int benchTreeBuild(void) {
+    printf("\ntree build (ms)   queue      heap   sorted+2q     arena\n");
+    for (int count = 256; count <= 65536; count *= 4) {
+        HuffmanNode **leaves = malloc((size_t)count * sizeof(HuffmanNode *));
+        node_t *weights = malloc((size_t)count * sizeof(node_t));
+        HuffmanArena arena;
+        if (leaves == NULL || weights == NULL || initArena(&arena, count) != 0) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            free(leaves);
+            free(weights);
+            return -1;
+        }
+        double times[4];
+        int failed = 0;
+        for (int method = 0; method < 3; method++) {
+            if (method == 0 && count > 16384) {
+                times[method] = -1; // The O(n^2) queue takes over a minute at 64K symbols
+                continue;
+            }
+            if (makeLeaves(leaves, count) != 0) {
+                failed = 1;
+                break;
+            }
+            double start = nowSeconds();
+            HuffmanNode *root = buildWithMethod(method, leaves, count);
+            times[method] = nowSeconds() - start;
+            if (root == NULL) {
+                failed = 1;
+                break;
+            }
+            freeHuffmanTree(root);
+        }
+
+        // The arena builds from node_t weights, as countFrequencies() fills them in
+        if (failed || makeLeaves(leaves, count) != 0) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            freeArena(&arena);
+            free(weights);
+            free(leaves);
+            return -1;
+        }
+        for (int i = 0; i < count; i++) {
+            weights[i].index = i;
+            weights[i].weight = leaves[i]->frequency;
+            free(leaves[i]);
+        }
+        arenaBuildTree(&arena, weights, count); // Warm the arena once, as a reused per-block arena would be
+        double start = nowSeconds();
+        arenaBuildTree(&arena, weights, count);
+        times[3] = nowSeconds() - start;
+        freeArena(&arena);
+        free(weights);
+        if (times[0] < 0) {
+            printf("%6d symbols %9s %9.3f %9.3f %9.3f\n", count, "-", times[1] * 1e3, times[2] * 1e3, times[3] * 1e3);
+        } else {
+            printf("%6d symbols %9.3f %9.3f %9.3f %9.3f\n", count, times[0] * 1e3, times[1] * 1e3, times[2] * 1e3, times[3] * 1e3);
+        }
+        free(leaves);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t corpusSize = BENCH_CORPUS_SIZE;
+    int warmup = BENCH_WARMUP;
+    int repetitions = BENCH_REPETITIONS;
+    const char *jsonName = NULL;
+    const char *files[BENCH_MAX_CORPORA];
+    int fileCount = 0;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] == '-' && argv[i][1] != '\0' && argv[i][2] == '\0' && i + 1 < argc) {
+            const char *value = argv[++i];
+            switch (argv[i - 1][1]) {
+            case 's': corpusSize = (size_t)strtoull(value, NULL, 10); break;
+            case 'w': warmup = atoi(value); break;
+            case 'r': repetitions = atoi(value); break;
+            case 'j': jsonName = value; break;
+            default: corpusSize = 0; break;
+            }
+        } else if (fileCount < BENCH_MAX_CORPORA) {
+            files[fileCount++] = argv[i];
+        }
+    }
+    if (corpusSize == 0 || warmup < 0 || repetitions < 1) {
+        fprintf(stderr, "Usage: %s [-s corpusSize] [-w warmup] [-r repetitions] [-j results.json] [FileName.txt ...]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *json = NULL;
+    if (jsonName != NULL) {
+        json = fopen(jsonName, "w");
+        if (json == NULL) {
+            fprintf(stderr, "Error: Unable to create file '%s'\n", jsonName);
+            return 1;
+        }
+        fprintf(json, "{\n  \"warmup\": %d,\n  \"repetitions\": %d,\n  \"streams\": %d,\n  \"corpora\": [",
+                warmup, repetitions, BENCH_STREAMS);
+    }
+    printf("warmup %d, %d timed repetitions per stage\n", warmup, repetitions);
+
+    int status = 0;
+    int first = 1;
+    int corpusCount = fileCount > 0 ? fileCount : (int)(sizeof generators / sizeof generators[0]);
+    for (int i = 0; i < corpusCount; i++) {
+        BenchCorpus corpus;
+        char filename[64];
+        if (fileCount > 0) {
+            corpus.name = files[i];
+            corpus.filename = files[i];
+        } else {
+            snprintf(filename, sizeof filename, "bench_%s.dat", generators[i].name);
+            if (writeCorpus(&generators[i], filename, corpusSize) != 0) {
+                status = -1;
+                continue;
+            }
+            corpus.name = generators[i].name;
+            corpus.filename = filename;
+        }
+        if (benchCorpus(&corpus, warmup, repetitions, json, &first) != 0) {
+            status = -1;
+        }
+    }
+
+    if (json != NULL) {
+        fprintf(json, "\n  ]\n}\n");
+        if (fclose(json) != 0) {
+            fprintf(stderr, "Error: Unable to write file '%s'\n", jsonName);
+            status = -1;
+        }
+    }
+
+    if (benchTreeBuild() != 0) {
+        status = -1;
+    }
+    return status == 0 ? 0 : 1;
+}
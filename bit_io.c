@@ -0,0 +1,43 @@
+#include "bit_io.h"
+
+/*****************************************************************************
+**
+* Filename: bit_io.c
+*
+* Description:
+* Setup and final flush for the BitWriter/BitReader pair declared in
+* bit_io.h. The per-code operations are inline in the header.
+*
+* Dependencies:
+* bit_io.h
+*****************************************************************************/
+void bitWriterInit(BitWriter *bw, unsigned char *out) {
+    bw->out = out;
+    bw->bytes = 0;
+    bw->bitBuffer = 0;
+    bw->bitCount = 0;
+}
+
+uint64_t bitWriterFinish(BitWriter *bw) {
+    uint64_t totalBits = (uint64_t)bw->bytes * 8 + bw->bitCount;
+
+    // Left-align the pending bits and store only the bytes they touch
+    if (bw->bitCount > 0) {
+        uint64_t word = bw->bitBuffer << (64 - bw->bitCount);
+        unsigned tailBytes = (bw->bitCount + 7) / 8;
+        for (unsigned i = 0; i < tailBytes; i++) {
+            bw->out[bw->bytes++] = (unsigned char)(word >> (56 - 8 * i));
+        }
+        bw->bitBuffer = 0;
+        bw->bitCount = 0;
+    }
+    return totalBits;
+}
+
+void bitReaderInit(BitReader *br, const unsigned char *in, uint64_t bitLength) {
+    br->in = in;
+    br->end = in + (size_t)((bitLength + 7) / 8);
+    br->bitBuffer = 0;
+    br->bitCount = 0;
+    br->bitsLeft = bitLength;
+}
@@ -0,0 +1,209 @@
+#ifndef BIT_IO_H
+#define BIT_IO_H
+/*****************************************************************************
+**
+* Filename: bit_io.h
+*
+* Description:
+* Bit-level writer and reader used by compress() and decompress(). Codes are
+* packed most-significant-bit first into a 64-bit accumulator, and whole
+* 64-bit words are flushed to the output buffer in big-endian byte order, so
+* the byte stream reads left to right in the same order the codes were
+* written. The hot put/peek/skip operations are inline; setup and the final
+* partial-word flush live in bit_io.c.
+*
+* Dependencies:
+* stddef.h
+* stdint.h
+* string.h
+*****************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*****************************************************************************
+**
+* Structure: BitWriter
+*
+* Fields:
+* out (unsigned char*) - Destination buffer for the packed bits.
+* bytes (size_t) - Number of bytes already flushed into `out`.
+* bitBuffer (uint64_t) - Pending bits, right-aligned. Bits above `bitCount` are stale and are shifted out before they are stored.
+* bitCount (unsigned) - Number of pending bits in `bitBuffer` (0-63).
+*****************************************************************************/
+typedef struct {
+    unsigned char *out;
+    size_t bytes;
+    uint64_t bitBuffer;
+    unsigned bitCount;
+} BitWriter;
+
+/*****************************************************************************
+**
+* Structure: BitReader
+*
+* Fields:
+* in (const unsigned char*) - Next byte to load into `bitBuffer`.
+* end (const unsigned char*) - One past the last byte holding payload bits. Reads past it return zero bits.
+* bitBuffer (uint64_t) - Loaded bits, left-aligned (the next bit is bit 63).
+* bitCount (unsigned) - Number of loaded bits in `bitBuffer`.
+* bitsLeft (uint64_t) - Payload bits not yet consumed.
+*****************************************************************************/
+typedef struct {
+    const unsigned char *in;
+    const unsigned char *end;
+    uint64_t bitBuffer;
+    unsigned bitCount;
+    uint64_t bitsLeft;
+} BitReader;
+
+static inline void storeBigEndian64(unsigned char *p, uint64_t v) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+    memcpy(p, &v, sizeof v);
+#else
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (unsigned char)v;
+        v >>= 8;
+    }
+#endif
+}
+
+static inline uint64_t loadBigEndian64(const unsigned char *p) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    memcpy(&v, p, sizeof v);
+    return __builtin_bswap64(v);
+#else
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+#endif
+}
+
+// Little-endian 32-bit fields, used by the block and container headers around the bit streams
+static inline void storeLittleEndian32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static inline uint32_t loadLittleEndian32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void storeLittleEndian64(unsigned char *p, uint64_t v) {
+    storeLittleEndian32(p, (uint32_t)v);
+    storeLittleEndian32(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline uint64_t loadLittleEndian64(const unsigned char *p) {
+    return (uint64_t)loadLittleEndian32(p) | ((uint64_t)loadLittleEndian32(p + 4) << 32);
+}
+
+/*****************************************************************************
+**
+* Function: bitWriterInit
+*
+* Purpose:
+* Prepares a writer that packs bits into `out`. The buffer must hold at least
+* ceil(totalBits / 8) bytes; nothing is written past that.
+*****************************************************************************/
+void bitWriterInit(BitWriter *bw, unsigned char *out);
+
+/*****************************************************************************
+**
+* Function: bitWriterPut
+*
+* Purpose:
+* Appends the low `length` bits of `code` (1-64), most significant bit first.
+* `code` must not have bits set above `length`. A full 64-bit word is stored
+* only when the accumulator overflows.
+*****************************************************************************/
+static inline void bitWriterPut(BitWriter *bw, uint64_t code, unsigned length) {
+    unsigned room = 64 - bw->bitCount;
+    if (length < room) {
+        bw->bitBuffer = (bw->bitBuffer << length) | code;
+        bw->bitCount += length;
+        return;
+    }
+
+    // Top up the accumulator to a whole word, flush it and keep the spill
+    unsigned spill = length - room;
+    uint64_t word = (room == 64 ? 0 : bw->bitBuffer << room) | (code >> spill);
+    storeBigEndian64(bw->out + bw->bytes, word);
+    bw->bytes += 8;
+    bw->bitBuffer = code;
+    bw->bitCount = spill;
+}
+
+/*****************************************************************************
+**
+* Function: bitWriterFinish
+*
+* Purpose:
+* Flushes the pending bits, zero-padding the last byte.
+*
+* Returns:
+* uint64_t - The exact number of bits written (before padding). The output occupies (bits + 7) / 8 bytes.
+*****************************************************************************/
+uint64_t bitWriterFinish(BitWriter *bw);
+
+/*****************************************************************************
+**
+* Function: bitReaderInit
+*
+* Purpose:
+* Prepares a reader over `bitLength` bits packed by a BitWriter.
+*****************************************************************************/
+void bitReaderInit(BitReader *br, const unsigned char *in, uint64_t bitLength);
+
+/*****************************************************************************
+**
+* Function: bitReaderRefill
+*
+* Purpose:
+* Tops `bitBuffer` up to at least 56 bits. Whole words are loaded while
+* eight input bytes remain; the tail is loaded byte by byte and padded with
+* zeros, so peeking past the end of the payload is always safe.
+*****************************************************************************/
+static inline void bitReaderRefill(BitReader *br) {
+    if (br->end - br->in >= 8) {
+        br->bitBuffer |= loadBigEndian64(br->in) >> br->bitCount;
+        br->in += (63 - br->bitCount) >> 3;
+        br->bitCount |= 56;
+        return;
+    }
+    while (br->bitCount <= 56) {
+        uint64_t byte = br->in < br->end ? *br->in++ : 0;
+        br->bitBuffer |= byte << (56 - br->bitCount);
+        br->bitCount += 8;
+    }
+}
+
+// Returns the next `n` bits (1-56) without consuming them. Call bitReaderRefill first.
+static inline uint64_t bitReaderPeek(const BitReader *br, unsigned n) {
+    return br->bitBuffer >> (64 - n);
+}
+
+// Consumes `n` bits that were made available by bitReaderRefill.
+static inline void bitReaderSkip(BitReader *br, unsigned n) {
+    br->bitBuffer <<= n;
+    br->bitCount -= n;
+    br->bitsLeft -= n;
+}
+
+// Reads a single bit, refilling when the buffer runs dry.
+static inline unsigned bitReaderGetBit(BitReader *br) {
+    if (br->bitCount == 0) {
+        bitReaderRefill(br);
+    }
+    unsigned bit = (unsigned)(br->bitBuffer >> 63);
+    bitReaderSkip(br, 1);
+    return bit;
+}
+
+#endif //BIT_IO_H
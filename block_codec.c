@@ -0,0 +1,476 @@
+#include <string.h>
+#include "block_codec.h"
+#include "bit_io.h"
+#include "canonical.h"
+#include "context_model.h"
+#include "crc32c.h"
+#include "decode_table.h"
+#include "huf_stats.h"
+
+/*****************************************************************************
+**
+* Filename: block_codec.c
+*
+* Description:
+* Single-block encoder and decoder (format in block_codec.h).
+*
+* Dependencies:
+* string.h
+* block_codec.h
+* bit_io.h
+* canonical.h
+* context_model.h
+* crc32c.h
+* decode_table.h
+* huf_stats.h
+*****************************************************************************/
+
+int blockCodeLengths(HuffmanArena *arena, const node_t nodes[], int count, uint8_t lengths[256]) {
+    for (int i = 0; i < 256; i++) {
+        lengths[i] = 0;
+    }
+    int root = arenaBuildTree(arena, nodes, count);
+    if (root < 0) {
+        return -1;
+    }
+    if (arenaCodeLengths(arena, root, lengths) == 0) {
+        int tooLong = 0;
+        for (int i = 0; i < count; i++) {
+            tooLong |= lengths[nodes[i].index] > HUF_BLOCK_MAX_CODE_LENGTH;
+        }
+        if (!tooLong) {
+            return 0;
+        }
+    }
+    return limitedCodeLengths(nodes, count, HUF_BLOCK_MAX_CODE_LENGTH, lengths);
+}
+
+// Writes the block prefix for a body of `bytes - HUF_BLOCK_PREFIX_SIZE` bytes and returns `bytes`
+static size_t finishBlock(const unsigned char *src, size_t size, unsigned char *dst, size_t bytes) {
+    HUF_STATS_TIMER(checksumStart);
+    storeLittleEndian32(dst, (uint32_t)size);
+    storeLittleEndian32(dst + 4, (uint32_t)(bytes - HUF_BLOCK_PREFIX_SIZE));
+    storeLittleEndian32(dst + 8, crc32c(0, src, size));
+    HUF_STATS_STAGE(HUF_STAGE_CHECKSUM, checksumStart);
+    HUF_STATS_ADD(blocksEncoded, 1);
+    HUF_STATS_ADD(encodeIn, size);
+    HUF_STATS_ADD(encodeOut, bytes);
+    return bytes;
+}
+
+// Plans an order-1 model and writes the block with it if it comes out below `limit` bytes. Returns the bytes
+// written, 0 if the model does not pay for itself, or -1 on error.
+static long encodeOrder1Block(HuffmanArena *arena, const unsigned char *src, size_t size, int streamCount, size_t limit,
+                              unsigned char *dst) {
+    Order1Model model;
+    HUF_STATS_TIMER(treeStart);
+    size_t bodySize = planOrder1Model(arena, src, size, streamCount, limit - HUF_BLOCK_PREFIX_SIZE - 1, &model);
+    HUF_STATS_STAGE(HUF_STAGE_TREE, treeStart);
+    if (bodySize == 0) {
+        return -1;
+    }
+    if (bodySize >= limit - HUF_BLOCK_PREFIX_SIZE - 1) {
+        return 0;
+    }
+
+    size_t bytes = HUF_BLOCK_PREFIX_SIZE;
+    dst[bytes++] = HUF_BLOCK_ORDER1;
+    bytes += writeOrder1Header(&model, dst + bytes);
+    dst[bytes++] = (unsigned char)streamCount;
+    unsigned char *jumpTable = dst + bytes;
+    bytes += 4 * (size_t)streamCount;
+    uint64_t streamBits[HUF_MAX_STREAMS];
+    HUF_STATS_TIMER(encodeStart);
+    bytes += encodeOrder1Streams(&model, src, size, streamCount, dst + bytes, streamBits);
+    HUF_STATS_STAGE(HUF_STAGE_ENCODE, encodeStart);
+    for (int s = 0; s < streamCount; s++) {
+        storeLittleEndian32(jumpTable + 4 * s, (uint32_t)streamBits[s]);
+        HUF_STATS_ADD(codedBits, streamBits[s]);
+    }
+    HUF_STATS_ADD(order1Blocks, 1);
+    return (long)finishBlock(src, size, dst, bytes);
+}
+
+// Codes the block with the previous table into `dst` as a HUF_BLOCK_REPEAT block and returns its size. With `nodes`,
+// the block is also counted into them on the way, and the result is 0 if the table has no code for one of its bytes.
+static size_t encodeRepeatBlock(const BlockTable *previous, const unsigned char *src, size_t size, int streamCount,
+                                unsigned char *dst, node_t nodes[256], int *uniqueCount) {
+    size_t bytes = HUF_BLOCK_PREFIX_SIZE;
+    dst[bytes++] = HUF_BLOCK_REPEAT;
+    dst[bytes++] = (unsigned char)streamCount;
+    unsigned char *jumpTable = dst + bytes;
+    bytes += 4 * (size_t)streamCount;
+    uint64_t streamBits[HUF_MAX_STREAMS];
+    uint64_t counts[256];
+    HUF_STATS_TIMER(encodeStart);
+    if (nodes != NULL) {
+        bytes += encodeStreamsCounting(previous->codes, src, size, streamCount, dst + bytes, streamBits, counts);
+    } else {
+        bytes += encodeStreams(previous->codes, src, size, streamCount, dst + bytes, streamBits);
+    }
+    HUF_STATS_STAGE(HUF_STAGE_ENCODE, encodeStart);
+    for (int s = 0; s < streamCount; s++) {
+        storeLittleEndian32(jumpTable + 4 * s, (uint32_t)streamBits[s]);
+    }
+    if (nodes == NULL) {
+        return bytes;
+    }
+
+    int covered = 1;
+    *uniqueCount = 0;
+    for (int symbol = 0; symbol < 256; symbol++) {
+        if (counts[symbol] > 0) {
+            nodes[*uniqueCount].index = symbol;
+            nodes[*uniqueCount].weight = counts[symbol];
+            (*uniqueCount)++;
+            covered &= previous->lengths[symbol] != 0;
+        }
+    }
+    return covered ? bytes : 0;
+}
+
+// Bounds the size of a Huffman block coding the counted bytes with `lengths` and a `headerBytes`-byte code header
+// (0 for a HUF_BLOCK_REPEAT block): each stream ends in 0 to 7 bits of padding. Returns the upper bound and stores
+// the lower one in `lower`, or returns SIZE_MAX if `lengths` has no code for one of the bytes.
+static size_t codedBlockSize(const node_t nodes[], int uniqueCount, const uint8_t lengths[256], size_t headerBytes,
+                             int streamCount, size_t *lower) {
+    uint64_t payloadBits = 0;
+    for (int i = 0; i < uniqueCount; i++) {
+        if (lengths[nodes[i].index] == 0) {
+            return SIZE_MAX;
+        }
+        payloadBits += nodes[i].weight * lengths[nodes[i].index];
+    }
+    size_t fixed = HUF_BLOCK_PREFIX_SIZE + 1 + headerBytes + 1 + 4 * (size_t)streamCount;
+    *lower = fixed + (size_t)((payloadBits + 7) / 8);
+    return fixed + (size_t)streamCount + (size_t)(payloadBits / 8);
+}
+
+// Builds code lengths from the nodes plus a node of weight 1 for every byte the previous block had and this one
+// lacks, so the table also codes bytes the next block is likely to have. Returns the padded node count, or -1 on
+// failure.
+static int paddedCodeLengths(HuffmanArena *arena, const BlockTable *previous, const node_t nodes[], int uniqueCount,
+                             uint8_t lengths[256]) {
+    node_t padded[256];
+    uint8_t present[256] = {0};
+    for (int i = 0; i < uniqueCount; i++) {
+        padded[i] = nodes[i];
+        present[nodes[i].index] = 1;
+    }
+    int count = uniqueCount;
+    for (int symbol = 0; symbol < 256; symbol++) {
+        if (previous->seen[symbol] && !present[symbol]) {
+            padded[count].index = symbol;
+            padded[count].weight = 1;
+            count++;
+        }
+    }
+    if (count == uniqueCount) {
+        return count;
+    }
+    return blockCodeLengths(arena, padded, count, lengths) == 0 ? count : -1;
+}
+
+size_t encodeBlock(HuffmanArena *arena, const unsigned char *src, size_t size, int streamCount, int contextOrder,
+                   BlockTable *previous, unsigned char *dst) {
+    if (size == 0 || size > HUF_MAX_BLOCK_SIZE) {
+        return 0;
+    }
+    if (streamCount < 1 || streamCount > HUF_MAX_STREAMS) {
+        return 0;
+    }
+    while (streamCount > 1 && size < (size_t)streamCount * HUF_MIN_SEGMENT_SIZE) {
+        streamCount--;
+    }
+
+    node_t nodes[256];
+    int uniqueCount = 0;
+    uint8_t lengths[256];
+    HuffmanCode codes[256];
+    // The table may be reused by blocks up to HUF_MAX_REPEAT_RUN after the one that wrote it, whatever their type
+    int canRepeat = previous != NULL && previous->valid && previous->repeats < HUF_MAX_REPEAT_RUN;
+    if (previous != NULL && previous->repeats < HUF_MAX_REPEAT_RUN) {
+        previous->repeats++;
+    }
+    // A block after one that reused the table is coded with it while it is counted, in one pass; repeatSize stays 0
+    // if the table cannot code it. Other blocks are counted first, so a block that does not reuse is coded once.
+    size_t repeatSize = 0;
+    if (canRepeat && previous->reused) {
+        repeatSize = encodeRepeatBlock(previous, src, size, streamCount, dst, nodes, &uniqueCount);
+    } else {
+        countBufferFrequencies(src, size, nodes, &uniqueCount);
+    }
+    if (previous != NULL) {
+        previous->reused = 0;
+    }
+    size_t bytes = HUF_BLOCK_PREFIX_SIZE;
+    if (uniqueCount == 1) {
+        if (previous != NULL) {
+            memset(previous->seen, 0, sizeof previous->seen);
+            previous->seen[nodes[0].index] = 1;
+        }
+        dst[bytes++] = HUF_BLOCK_RLE;
+        dst[bytes++] = (unsigned char)nodes[0].index;
+        HUF_STATS_ADD(rleBlocks, 1);
+        return finishBlock(src, size, dst, bytes);
+    }
+    HUF_STATS_TIMER(treeStart);
+    if (blockCodeLengths(arena, nodes, uniqueCount, lengths) != 0) {
+        return 0;
+    }
+    unsigned char header[CODE_LENGTH_HEADER_MAX];
+    size_t headerBytes = writeCodeLengthHeader(lengths, header);
+    size_t huffmanLower;
+    size_t huffmanSize = codedBlockSize(nodes, uniqueCount, lengths, headerBytes, streamCount, &huffmanLower);
+    // A table padded with the previous block's other bytes suits a later block better, so it is kept when it cannot
+    // come out larger than the block's own
+    if (previous != NULL) {
+        uint8_t paddedLengths[256];
+        unsigned char paddedHeader[CODE_LENGTH_HEADER_MAX];
+        int paddedCount = paddedCodeLengths(arena, previous, nodes, uniqueCount, paddedLengths);
+        if (paddedCount < 0) {
+            return 0;
+        }
+        if (paddedCount > uniqueCount) {
+            size_t paddedHeaderBytes = writeCodeLengthHeader(paddedLengths, paddedHeader);
+            size_t paddedLower;
+            size_t paddedSize = codedBlockSize(nodes, uniqueCount, paddedLengths, paddedHeaderBytes, streamCount, &paddedLower);
+            if (paddedSize <= huffmanLower) {
+                memcpy(lengths, paddedLengths, sizeof paddedLengths);
+                memcpy(header, paddedHeader, paddedHeaderBytes);
+                headerBytes = paddedHeaderBytes;
+                huffmanSize = paddedSize;
+                huffmanLower = paddedLower;
+            }
+        }
+        memset(previous->seen, 0, sizeof previous->seen);
+        for (int i = 0; i < uniqueCount; i++) {
+            previous->seen[nodes[i].index] = 1;
+        }
+    }
+    HUF_STATS_STAGE(HUF_STAGE_TREE, treeStart);
+    size_t storedSize = HUF_BLOCK_PREFIX_SIZE + 1 + size;
+    size_t bestSize = huffmanSize < storedSize ? huffmanSize : storedSize;
+
+    // The table is reused only when a new one could not come out smaller with its header counted. A counted block
+    // is priced with it first, and only coded with it if that holds.
+    size_t repeatLimit = huffmanLower < storedSize ? huffmanLower : storedSize;
+    size_t repeatLower;
+    if (canRepeat && repeatSize == 0 &&
+        codedBlockSize(nodes, uniqueCount, previous->lengths, 0, streamCount, &repeatLower) <= repeatLimit) {
+        repeatSize = encodeRepeatBlock(previous, src, size, streamCount, dst, NULL, NULL);
+    }
+    if (repeatSize != 0 && repeatSize <= repeatLimit) {
+        // An order-1 block may still be smaller; it only overwrites dst if it is
+        if (contextOrder == 1 && size >= HUF_ORDER1_MIN_BLOCK_SIZE) {
+            long order1Size = encodeOrder1Block(arena, src, size, streamCount, repeatSize, dst);
+            if (order1Size != 0) {
+                return order1Size > 0 ? (size_t)order1Size : 0;
+            }
+        }
+        for (int s = 0; s < streamCount; s++) {
+            HUF_STATS_ADD(codedBits, loadLittleEndian32(dst + HUF_BLOCK_PREFIX_SIZE + 2 + 4 * s));
+        }
+        HUF_STATS_ADD(repeatBlocks, 1);
+        previous->reused = 1;
+        return finishBlock(src, size, dst, repeatSize);
+    }
+    if (contextOrder == 1 && size >= HUF_ORDER1_MIN_BLOCK_SIZE) {
+        long order1Size = encodeOrder1Block(arena, src, size, streamCount, bestSize, dst);
+        if (order1Size != 0) {
+            return order1Size > 0 ? (size_t)order1Size : 0;
+        }
+    }
+    if (huffmanSize >= storedSize) {
+        bytes = HUF_BLOCK_PREFIX_SIZE;
+        dst[bytes++] = HUF_BLOCK_STORED;
+        memcpy(dst + bytes, src, size);
+        HUF_STATS_ADD(storedBlocks, 1);
+        return finishBlock(src, size, dst, bytes + size);
+    }
+
+    HUF_STATS_TIMER(codesStart);
+    if (canonicalCodes(lengths, codes) != 0) {
+        return 0;
+    }
+    HUF_STATS_STAGE(HUF_STAGE_CODES, codesStart);
+#ifdef HUF_STATS
+    uint64_t counts[256] = {0};
+    for (int i = 0; i < uniqueCount; i++) {
+        counts[nodes[i].index] = nodes[i].weight;
+    }
+    HUF_STATS_CODES(counts, lengths);
+#endif
+
+    dst[bytes++] = HUF_BLOCK_HUFFMAN;
+    memcpy(dst + bytes, header, headerBytes);
+    bytes += headerBytes;
+    dst[bytes++] = (unsigned char)streamCount;
+    unsigned char *jumpTable = dst + bytes;
+    bytes += 4 * (size_t)streamCount;
+    uint64_t streamBits[HUF_MAX_STREAMS];
+    HUF_STATS_TIMER(encodeStart);
+    bytes += encodeStreams(codes, src, size, streamCount, dst + bytes, streamBits);
+    HUF_STATS_STAGE(HUF_STAGE_ENCODE, encodeStart);
+    for (int s = 0; s < streamCount; s++) {
+        storeLittleEndian32(jumpTable + 4 * s, (uint32_t)streamBits[s]);
+        HUF_STATS_ADD(codedBits, streamBits[s]);
+    }
+    if (previous != NULL) {
+        previous->valid = 1;
+        previous->repeats = 0;
+        memcpy(previous->lengths, lengths, sizeof lengths);
+        memcpy(previous->codes, codes, sizeof codes);
+    }
+    return finishBlock(src, size, dst, bytes);
+}
+
+int readBlockPrefix(const unsigned char *prefix, size_t *rawSize, size_t *bodySize) {
+    *rawSize = loadLittleEndian32(prefix);
+    *bodySize = loadLittleEndian32(prefix + 4);
+    if (*rawSize > HUF_MAX_BLOCK_SIZE || *bodySize > HUF_BLOCK_BOUND(*rawSize) - HUF_BLOCK_PREFIX_SIZE) {
+        return -1;
+    }
+    return 0;
+}
+
+// Reads the stream count and jump table that follow a `headerBytes`-byte code header. The streams' lengths
+// must add up to exactly the rest of the body. Returns the stream count, or -1 if the table is malformed.
+static int readJumpTable(const unsigned char *body, size_t bodySize, size_t headerBytes, uint64_t streamBits[],
+                         const unsigned char **payload) {
+    if (bodySize - headerBytes < 1) {
+        return -1;
+    }
+    int streamCount = body[headerBytes];
+    size_t used = headerBytes + 1 + 4 * (size_t)streamCount;
+    if (streamCount < 1 || streamCount > HUF_MAX_STREAMS || used > bodySize) {
+        return -1;
+    }
+    *payload = body + used;
+    for (int s = 0; s < streamCount; s++) {
+        streamBits[s] = loadLittleEndian32(body + headerBytes + 1 + 4 * s);
+        used += (size_t)((streamBits[s] + 7) / 8);
+    }
+    return used == bodySize ? streamCount : -1;
+}
+
+// Decodes the streams that follow a `headerBytes`-byte header in a HUF_BLOCK_HUFFMAN or HUF_BLOCK_REPEAT body
+// (after the type byte) with the code `lengths`, into `rawSize` bytes of `dst`
+static int decodeHuffmanStreams(const uint8_t lengths[256], const unsigned char *body, size_t bodySize, size_t headerBytes,
+                                unsigned char *dst, size_t rawSize) {
+    HuffmanCode codes[256];
+    uint64_t streamBits[HUF_MAX_STREAMS];
+    const unsigned char *payload;
+    if (canonicalCodes(lengths, codes) != 0) {
+        return -1;
+    }
+    int streamCount = readJumpTable(body, bodySize, headerBytes, streamBits, &payload);
+    if (streamCount < 0) {
+        return -1;
+    }
+
+    DecodeTable table;
+    if (buildDecodeTableFromCodes(&table, codes) != 0) {
+        return -1;
+    }
+    int status = decodeStreamsWithTable(&table, payload, streamBits, streamCount, (char*)dst, rawSize);
+    freeDecodeTable(&table);
+    return status;
+}
+
+// Decodes the body of a HUF_BLOCK_ORDER1 block (after the type byte) into `rawSize` bytes of `dst`
+static int decodeOrder1Body(const unsigned char *body, size_t bodySize, unsigned char *dst, size_t rawSize) {
+    Order1Model model;
+    uint64_t streamBits[HUF_MAX_STREAMS];
+    const unsigned char *payload;
+    long headerBytes = readOrder1Header(body, bodySize, &model);
+    if (headerBytes < 0) {
+        return -1;
+    }
+    int streamCount = readJumpTable(body, bodySize, (size_t)headerBytes, streamBits, &payload);
+    if (streamCount < 0) {
+        return -1;
+    }
+    return decodeOrder1Streams(&model, payload, streamBits, streamCount, dst, rawSize);
+}
+
+int decodeBlock(const unsigned char *block, size_t blockSize, unsigned char *dst, size_t capacity, size_t *decodedSize,
+                BlockTable *table) {
+    size_t rawSize;
+    size_t bodySize;
+    *decodedSize = 0;
+    if (blockSize < HUF_BLOCK_PREFIX_SIZE || readBlockPrefix(block, &rawSize, &bodySize) != 0 ||
+        bodySize > blockSize - HUF_BLOCK_PREFIX_SIZE || rawSize > capacity || bodySize < 1) {
+        return -1;
+    }
+
+    const unsigned char *body = block + HUF_BLOCK_PREFIX_SIZE;
+    int status = -1;
+    uint8_t lengths[256];
+    long headerBytes;
+    HUF_STATS_TIMER(decodeStart);
+    switch (body[0]) {
+        case HUF_BLOCK_HUFFMAN:
+            headerBytes = readCodeLengthHeader(body + 1, bodySize - 1, lengths);
+            if (headerBytes >= 0) {
+                status = decodeHuffmanStreams(lengths, body + 1, bodySize - 1, (size_t)headerBytes, dst, rawSize);
+            }
+            break;
+        case HUF_BLOCK_REPEAT:
+            if (table != NULL && table->valid) {
+                status = decodeHuffmanStreams(table->lengths, body + 1, bodySize - 1, 0, dst, rawSize);
+            }
+            break;
+        case HUF_BLOCK_STORED:
+            if (bodySize - 1 == rawSize) {
+                memcpy(dst, body + 1, rawSize);
+                status = 0;
+            }
+            break;
+        case HUF_BLOCK_ORDER1:
+            status = decodeOrder1Body(body + 1, bodySize - 1, dst, rawSize);
+            break;
+        case HUF_BLOCK_RLE:
+            if (bodySize == 2) {
+                memset(dst, body[1], rawSize);
+                status = 0;
+            }
+            break;
+        default:
+            break;
+    }
+    HUF_STATS_STAGE(HUF_STAGE_DECODE, decodeStart);
+    HUF_STATS_TIMER(checksumStart);
+    if (status == 0 && crc32c(0, dst, rawSize) != loadLittleEndian32(block + 8)) {
+        status = -1;
+    }
+    HUF_STATS_STAGE(HUF_STAGE_CHECKSUM, checksumStart);
+    if (status == 0 && body[0] == HUF_BLOCK_HUFFMAN && table != NULL) {
+        table->valid = 1;
+        memcpy(table->lengths, lengths, sizeof lengths);
+    }
+    *decodedSize = status == 0 ? rawSize : 0;
+    HUF_STATS_ADD(blocksDecoded, 1);
+    HUF_STATS_ADD(decodeIn, HUF_BLOCK_PREFIX_SIZE + bodySize);
+    HUF_STATS_ADD(decodeOut, *decodedSize);
+    return status;
+}
+
+int blockTableAdvance(const unsigned char *block, size_t blockSize, BlockTable *table) {
+    size_t rawSize;
+    size_t bodySize;
+    if (blockSize < HUF_BLOCK_PREFIX_SIZE + 1 || readBlockPrefix(block, &rawSize, &bodySize) != 0 ||
+        bodySize > blockSize - HUF_BLOCK_PREFIX_SIZE || bodySize < 1) {
+        return -1;
+    }
+    const unsigned char *body = block + HUF_BLOCK_PREFIX_SIZE;
+    if (body[0] != HUF_BLOCK_HUFFMAN) {
+        return 0;
+    }
+    if (readCodeLengthHeader(body + 1, bodySize - 1, table->lengths) < 0) {
+        table->valid = 0;
+        return -1;
+    }
+    table->valid = 1;
+    return 0;
+}
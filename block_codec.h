@@ -0,0 +1,207 @@
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+/*****************************************************************************
+**
+* Filename: block_codec.h
+*
+* Description:
+* Encodes and decodes one block. Blocks normally carry their own canonical
+* code-length header, so they can be decoded independently and each one
+* adapts to the statistics of its own data. Code lengths are
+* limited to HUF_BLOCK_MAX_CODE_LENGTH, which makes every code resolve with
+* a single DecodeTable probe.
+*
+* The encoder prices each block from its histogram before coding it. A
+* block of a single byte value is stored as that value (RLE), and a block
+* that Huffman coding would not shrink (media, already compressed data) is
+* stored as is, so neither pays for bit packing or grows. When the caller
+* asks for order-1 modelling, the clustered per-context code of
+* context_model.h is priced as well and used when it is smaller.
+*
+* A caller that passes a BlockTable lets a block reuse the code of the
+* last Huffman block before it (HUF_BLOCK_REPEAT), when that is no larger
+* than writing a new table with its header. While blocks keep reusing the
+* table, the next one is coded with it as it is counted, in one pass;
+* other blocks are counted first and priced both ways, so a block that
+* writes a new table is only coded once. Such a block can only be decoded
+* with the BlockTable its predecessors left, so decoders keep one per
+* stream. A HUF_BLOCK_REPEAT block from this encoder is never more than
+* HUF_MAX_REPEAT_RUN blocks (of any type) after the Huffman block that
+* wrote its table, which bounds how far back a random-access reader has to
+* look for it.
+*
+* The payload is split into up to HUF_MAX_STREAMS independent bit streams
+* (4 by default) that cover consecutive segments of the block, so the
+* decoder can run one decode chain per stream in a single interleaved loop.
+*
+* Block format:
+* rawSize (4 bytes, little-endian) - Bytes of input in the block (1 - HUF_MAX_BLOCK_SIZE).
+* bodySize (4 bytes, little-endian) - Bytes in the rest of the block.
+* checksum (4 bytes, little-endian) - CRC-32C of the block's input bytes, checked after decoding.
+* type (1 byte) - A HufBlockType, which selects the rest of the body:
+* HUF_BLOCK_HUFFMAN:
+*   code-length header - 256 lengths in the format of canonical.h.
+*   streamCount (1 byte) - Number of bit streams (1 - HUF_MAX_STREAMS).
+*   jump table - The length of each stream in bits (4 bytes each, little-endian).
+*   payload - The streams back to back, each padded to a whole byte.
+* HUF_BLOCK_STORED:
+*   The rawSize input bytes.
+* HUF_BLOCK_RLE:
+*   The byte value repeated rawSize times (1 byte).
+* HUF_BLOCK_ORDER1:
+*   order-1 header - The context map and code tables, in the format of context_model.h.
+*   streamCount, jump table, payload - As for HUF_BLOCK_HUFFMAN.
+* HUF_BLOCK_REPEAT:
+*   streamCount, jump table, payload - As for HUF_BLOCK_HUFFMAN, coded with the last HUF_BLOCK_HUFFMAN block's code lengths.
+*
+* Dependencies:
+* compress_and_decompress.h
+* huffman_arena.h
+*****************************************************************************/
+#include "compress_and_decompress.h"
+#include "huffman_arena.h"
+
+#define HUF_BLOCK_MAX_CODE_LENGTH 11
+#define HUF_DEFAULT_BLOCK_SIZE ((size_t)256 << 10)
+#define HUF_MAX_BLOCK_SIZE ((size_t)16 << 20)
+#define HUF_BLOCK_PREFIX_SIZE 12
+#define HUF_DEFAULT_STREAM_COUNT 4
+
+// Blocks are not split into segments shorter than this; the jump table and padding would outweigh the gain
+#define HUF_MIN_SEGMENT_SIZE 1024
+
+// Consecutive HUF_BLOCK_REPEAT blocks the encoder writes before it starts a new table
+#define HUF_MAX_REPEAT_RUN 16
+
+// Largest encoded size of a block holding `rawSize` bytes (prefix, type, header, jump table and padded streams)
+#define HUF_BLOCK_BOUND(rawSize) \
+    (HUF_BLOCK_PREFIX_SIZE + 1 + 256 + 1 + 5 * HUF_MAX_STREAMS + ((size_t)(rawSize) * HUF_BLOCK_MAX_CODE_LENGTH + 7) / 8)
+
+typedef enum {
+    HUF_BLOCK_HUFFMAN,  // Canonical Huffman code, split into bit streams
+    HUF_BLOCK_STORED,   // The input bytes, unchanged
+    HUF_BLOCK_RLE,      // One byte value repeated for the whole block
+    HUF_BLOCK_ORDER1,   // A code table per cluster of previous-byte contexts, split into bit streams
+    HUF_BLOCK_REPEAT    // The previous Huffman block's code, split into bit streams
+} HufBlockType;
+
+/*****************************************************************************
+**
+* Structure: BlockTable
+*
+* Fields:
+* valid (int) - Set once a HUF_BLOCK_HUFFMAN block has been coded or decoded; start with a zeroed BlockTable.
+* repeats (int) - Blocks of any type the encoder has written since this table, up to HUF_MAX_REPEAT_RUN, after which none may reuse it.
+* reused (int) - Set when the last block was a HUF_BLOCK_REPEAT block, so the encoder tries the table on the next one while counting it (kept by the encoder only).
+* lengths (uint8_t[]) - The code lengths of that Huffman block.
+* codes (HuffmanCode[]) - Canonical codes for `lengths` (kept by the encoder only).
+* seen (uint8_t[]) - Byte values that occurred in the previous block (kept by the encoder only).
+*****************************************************************************/
+typedef struct {
+    int valid;
+    int repeats;
+    int reused;
+    uint8_t lengths[256];
+    HuffmanCode codes[256];
+    uint8_t seen[256];
+} BlockTable;
+
+/*****************************************************************************
+**
+* Function: blockCodeLengths
+*
+* Purpose:
+* Code lengths for one block's counts: the depths of the Huffman tree
+* built in `arena` when none exceeds HUF_BLOCK_MAX_CODE_LENGTH, otherwise
+* limitedCodeLengths() with that limit.
+*
+* Returns:
+* int - 0 on success, -1 if the tree cannot be built or memory allocation fails.
+*****************************************************************************/
+int blockCodeLengths(HuffmanArena *arena, const node_t nodes[], int count, uint8_t lengths[256]);
+
+/*****************************************************************************
+**
+* Function: encodeBlock
+*
+* Purpose:
+* Counts the block, builds its code in `arena` (falling back to
+* limitedCodeLengths() when the tree is deeper than
+* HUF_BLOCK_MAX_CODE_LENGTH) and writes the encoded block to `dst`. Blocks
+* too short for `streamCount` segments of HUF_MIN_SEGMENT_SIZE bytes use
+* fewer streams. The code lengths and counts give the exact Huffman size
+* before anything is packed; when it is not below the stored size the
+* block is stored instead, and a block of one byte value is always RLE.
+* With a `contextOrder` of 1, blocks of at least HUF_ORDER1_MIN_BLOCK_SIZE
+* bytes also plan an order-1 model (see context_model.h), which costs a
+* pass over the byte pairs and the clustering, and keep it if it is the
+* smallest coding. With a valid `previous` table, the block is first coded
+* with it while it is counted; that coding is kept when no other is
+* smaller and the table has every byte of the block.
+*
+* Parameters:
+* arena (HuffmanArena*) - Scratch tree storage for at least 256 symbols; reused across blocks.
+* src (const unsigned char*) - The block's input bytes.
+* size (size_t) - Number of input bytes (1 - HUF_MAX_BLOCK_SIZE).
+* streamCount (int) - Bit streams to split the payload into (1 - HUF_MAX_STREAMS).
+* contextOrder (int) - 0 for order-0 codes only, 1 to also try order-1 modelling.
+* previous (BlockTable*) - NULL for a self-contained block; otherwise the table the previous blocks left, which is updated when this block writes a new one.
+* dst (unsigned char*) - Output buffer of at least HUF_BLOCK_BOUND(size) bytes.
+*
+* Returns:
+* size_t - Bytes written to `dst`, or 0 on error.
+*****************************************************************************/
+size_t encodeBlock(HuffmanArena *arena, const unsigned char *src, size_t size, int streamCount, int contextOrder,
+                   BlockTable *previous, unsigned char *dst);
+
+/*****************************************************************************
+**
+* Function: readBlockPrefix
+*
+* Purpose:
+* Reads the sizes from the prefix of a block. A rawSize of 0 is the
+* end-of-stream marker written by the stream encoder.
+*
+* Returns:
+* int - 0 if the sizes are plausible, -1 if rawSize exceeds HUF_MAX_BLOCK_SIZE or bodySize exceeds the bound for rawSize.
+*****************************************************************************/
+int readBlockPrefix(const unsigned char *prefix, size_t *rawSize, size_t *bodySize);
+
+/*****************************************************************************
+**
+* Function: decodeBlock
+*
+* Purpose:
+* Decodes one complete block (prefix included) into `dst` and checks the
+* decoded bytes against the block's checksum.
+*
+* Parameters:
+* block (const unsigned char*) - The encoded block.
+* blockSize (size_t) - Bytes available at `block`; must cover the whole block.
+* dst (unsigned char*) - Output buffer.
+* capacity (size_t) - Size of `dst`; must be at least the block's rawSize.
+* decodedSize (size_t*) - Receives the number of bytes decoded.
+* table (BlockTable*) - The table the stream's earlier blocks left, updated by a Huffman block; NULL rejects HUF_BLOCK_REPEAT blocks.
+*
+* Returns:
+* int - 0 on success, -1 if the block is malformed, truncated, fails its checksum, does not fit in `dst`, or repeats a table that `table` does not hold.
+*****************************************************************************/
+int decodeBlock(const unsigned char *block, size_t blockSize, unsigned char *dst, size_t capacity, size_t *decodedSize,
+                BlockTable *table);
+
+/*****************************************************************************
+**
+* Function: blockTableAdvance
+*
+* Purpose:
+* Updates `table` past one complete block without decoding it: a
+* HUF_BLOCK_HUFFMAN block's code lengths replace it, and other blocks
+* leave it as it is. Lets a parallel or random-access decoder give each
+* block the table it will need.
+*
+* Returns:
+* int - 0 on success, -1 if the block is truncated or its code-length header is malformed.
+*****************************************************************************/
+int blockTableAdvance(const unsigned char *block, size_t blockSize, BlockTable *table);
+
+#endif //BLOCK_CODEC_H
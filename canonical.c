@@ -0,0 +1,425 @@
+#include <stdlib.h>
+#include <string.h>
+#include "canonical.h"
+#include "bit_io.h"
+#include "file_input.h"
+#include "huffman_arena.h"
+
+/*****************************************************************************
+**
+* Filename: canonical.c
+*
+* Description:
+* Length-limited code lengths (package-merge), canonical code assignment,
+* the run-length code-length header, and the canonical compress/decompress
+* pair built on the BitWriter and the DecodeTable.
+*
+* Dependencies:
+* stdlib.h
+* string.h
+* canonical.h
+* bit_io.h
+* file_input.h
+* huffman_arena.h
+*****************************************************************************/
+
+static int recordDepths(HuffmanNode *node, unsigned depth, uint8_t lengths[256]) {
+    if (node->left == NULL && node->right == NULL) {
+        lengths[(unsigned char)node->data] = (uint8_t)depth;
+        return 0;
+    }
+    if (depth == HUF_MAX_CODE_LENGTH) {
+        return -1;
+    }
+    if (node->left != NULL && recordDepths(node->left, depth + 1, lengths) != 0) {
+        return -1;
+    }
+    if (node->right != NULL && recordDepths(node->right, depth + 1, lengths) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int codeLengthsFromTree(HuffmanNode *root, uint8_t lengths[256]) {
+    for (int i = 0; i < 256; i++) {
+        lengths[i] = 0;
+    }
+    if (root == NULL) {
+        return 0;
+    }
+    if (root->left == NULL && root->right == NULL) {
+        lengths[(unsigned char)root->data] = 1; // Same 1-bit code HuffmanCodes() gives a lone symbol
+        return 0;
+    }
+    return recordDepths(root, 0, lengths);
+}
+
+// Orders symbols by ascending weight, ties by symbol, so the lightest get the longest codes
+static int compareByWeight(const void *a, const void *b) {
+    const node_t *x = a;
+    const node_t *y = b;
+    if (x->weight != y->weight) {
+        return x->weight < y->weight ? -1 : 1;
+    }
+    return x->index - y->index;
+}
+
+int limitedCodeLengths(const node_t nodes[], int count, unsigned maxLength, uint8_t lengths[256]) {
+    for (int i = 0; i < 256; i++) {
+        lengths[i] = 0;
+    }
+    if (count <= 0) {
+        return 0;
+    }
+    if (maxLength == 0 || maxLength > HUF_MAX_CODE_LENGTH || ((uint64_t)1 << maxLength) < (uint64_t)count) {
+        return -1;
+    }
+    if (count == 1) {
+        lengths[(unsigned char)nodes[0].index] = 1;
+        return 0;
+    }
+
+    size_t listSize = 2 * (size_t)count;
+    node_t *leaves = malloc((size_t)count * sizeof(node_t));
+    uint64_t *previous = malloc(listSize * sizeof(uint64_t));
+    uint64_t *current = malloc(listSize * sizeof(uint64_t));
+    unsigned char *isLeaf = malloc(maxLength * listSize); // Per level: whether each list item is a leaf or a package
+    if (leaves == NULL || previous == NULL || current == NULL || isLeaf == NULL) {
+        free(leaves);
+        free(previous);
+        free(current);
+        free(isLeaf);
+        return -1;
+    }
+    memcpy(leaves, nodes, (size_t)count * sizeof(node_t));
+    qsort(leaves, (size_t)count, sizeof(node_t), compareByWeight);
+
+    // The deepest level's list is just the leaves
+    size_t previousSize = (size_t)count;
+    unsigned char *levelFlags = isLeaf + (maxLength - 1) * listSize;
+    for (int i = 0; i < count; i++) {
+        previous[i] = leaves[i].weight;
+        levelFlags[i] = 1;
+    }
+
+    // Each shallower level merges the leaves with pairs ("packages") of the level below it
+    for (unsigned level = maxLength - 1; level >= 1; level--) {
+        levelFlags = isLeaf + (level - 1) * listSize;
+        size_t packages = previousSize / 2;
+        size_t leaf = 0;
+        size_t package = 0;
+        size_t size = 0;
+        while (leaf < (size_t)count || package < packages) {
+            uint64_t packageWeight = package < packages ? previous[2 * package] + previous[2 * package + 1] : 0;
+            if (package == packages || (leaf < (size_t)count && leaves[leaf].weight <= packageWeight)) {
+                current[size] = leaves[leaf++].weight;
+                levelFlags[size++] = 1;
+            } else {
+                current[size] = packageWeight;
+                levelFlags[size++] = 0;
+                package++;
+            }
+        }
+        uint64_t *swap = previous;
+        previous = current;
+        current = swap;
+        previousSize = size;
+    }
+
+    // Take the 2n - 2 cheapest items of the top list and follow the packages down: every level in
+    // which a leaf is taken adds one bit to its code. Leaves are taken lightest first at every level.
+    size_t take = 2 * (size_t)count - 2;
+    for (unsigned level = 1; level <= maxLength && take > 0; level++) {
+        levelFlags = isLeaf + (level - 1) * listSize;
+        size_t leavesTaken = 0;
+        for (size_t i = 0; i < take; i++) {
+            leavesTaken += levelFlags[i];
+        }
+        for (size_t i = 0; i < leavesTaken; i++) {
+            lengths[(unsigned char)leaves[i].index]++;
+        }
+        take = 2 * (take - leavesTaken);
+    }
+
+    free(leaves);
+    free(previous);
+    free(current);
+    free(isLeaf);
+    return 0;
+}
+
+int canonicalCodes(const uint8_t lengths[256], HuffmanCode codes[256]) {
+    unsigned lengthCount[HUF_MAX_CODE_LENGTH + 1] = {0};
+    uint64_t kraft = 0; // Code space used, in units of 2^-HUF_MAX_CODE_LENGTH
+
+    for (int symbol = 0; symbol < 256; symbol++) {
+        if (lengths[symbol] > HUF_MAX_CODE_LENGTH) {
+            return -1;
+        }
+        if (lengths[symbol] > 0) {
+            lengthCount[lengths[symbol]]++;
+            kraft += (uint64_t)1 << (HUF_MAX_CODE_LENGTH - lengths[symbol]);
+        }
+    }
+    if (kraft > ((uint64_t)1 << HUF_MAX_CODE_LENGTH)) {
+        return -1; // Over-subscribed: the codes could not all be prefix-free
+    }
+
+    // First code of each length: shorter codes take the numerically smaller prefixes
+    uint64_t nextCode[HUF_MAX_CODE_LENGTH + 1] = {0};
+    uint64_t code = 0;
+    for (int length = 1; length <= HUF_MAX_CODE_LENGTH; length++) {
+        code = (code + lengthCount[length - 1]) << 1;
+        nextCode[length] = code;
+    }
+
+    for (int symbol = 0; symbol < 256; symbol++) {
+        codes[symbol].length = lengths[symbol];
+        codes[symbol].code = lengths[symbol] > 0 ? (uint32_t)nextCode[lengths[symbol]]++ : 0;
+    }
+    return 0;
+}
+
+size_t writeCodeLengthHeader(const uint8_t lengths[256], unsigned char *out) {
+    size_t bytes = 0;
+    uint8_t previous = 0;
+    int symbol = 0;
+    while (symbol < 256) {
+        int run = 0;
+        while (symbol + run < 256 && run < 128 && lengths[symbol + run] == previous) {
+            run++;
+        }
+        if (run > 0) {
+            out[bytes++] = (unsigned char)(0x80 | (run - 1));
+            symbol += run;
+        } else {
+            previous = lengths[symbol++];
+            out[bytes++] = previous;
+        }
+    }
+    return bytes;
+}
+
+long readCodeLengthHeader(const unsigned char *in, size_t size, uint8_t lengths[256]) {
+    size_t bytes = 0;
+    uint8_t previous = 0;
+    int symbol = 0;
+    while (symbol < 256) {
+        if (bytes == size) {
+            return -1; // Truncated header
+        }
+        unsigned char item = in[bytes++];
+        if (item & 0x80) {
+            int run = (item & 0x7F) + 1;
+            if (symbol + run > 256) {
+                return -1;
+            }
+            while (run-- > 0) {
+                lengths[symbol++] = previous;
+            }
+        } else {
+            if (item > HUF_MAX_CODE_LENGTH) {
+                return -1;
+            }
+            previous = item;
+            lengths[symbol++] = item;
+        }
+    }
+    return (long)bytes;
+}
+
+// Appends one code to the local accumulator; the caller keeps `pending` + the code length within 63 bits
+#define ENCODE_PUT(symbol) do { \
+        const HuffmanCode *code_ = &codes[symbol]; \
+        accumulator = (accumulator << code_->length) | code_->code; \
+        pending += code_->length; \
+    } while (0)
+// Stores the whole bytes of the accumulator as one big-endian word and keeps the 0-7 leftover bits
+#define ENCODE_FLUSH() do { \
+        storeBigEndian64(out, accumulator << (63 - pending) << 1); \
+        out += pending >> 3; \
+        pending &= 7; \
+    } while (0)
+
+// Encodes four symbols per step with a flush after every `perFlush` (1, 2 or 4) of them, and leaves the final
+// 64 + 3 symbols (or fewer) to the caller: every code is at least a bit long, so each stored word lies inside
+// the output (a table with unused zero-length codes can store up to a word past it). When `counts` is not NULL
+// the four symbols of a step also go into its four tables. Inlined once per perFlush and counting choice, so the
+// branches on them fold away.
+static inline __attribute__((always_inline)) size_t encodeFast(const HuffmanCode codes[256], const unsigned char *src,
+                                                                 size_t size, int perFlush, uint32_t counts[][256],
+                                                                 BitWriter *writer) {
+    unsigned char *out = writer->out;
+    uint64_t accumulator = 0;
+    unsigned pending = 0;
+    size_t i = 0;
+    for (; size - i >= 4 + 64; i += 4) {
+        if (counts != NULL) {
+            counts[0][src[i]]++;
+            counts[1][src[i + 1]]++;
+            counts[2][src[i + 2]]++;
+            counts[3][src[i + 3]]++;
+        }
+        if (perFlush == 4) {
+            ENCODE_PUT(src[i]);
+            ENCODE_PUT(src[i + 1]);
+            ENCODE_PUT(src[i + 2]);
+            ENCODE_PUT(src[i + 3]);
+            ENCODE_FLUSH();
+        } else if (perFlush == 2) {
+            ENCODE_PUT(src[i]);
+            ENCODE_PUT(src[i + 1]);
+            ENCODE_FLUSH();
+            ENCODE_PUT(src[i + 2]);
+            ENCODE_PUT(src[i + 3]);
+            ENCODE_FLUSH();
+        } else {
+            ENCODE_PUT(src[i]);
+            ENCODE_FLUSH();
+            ENCODE_PUT(src[i + 1]);
+            ENCODE_FLUSH();
+            ENCODE_PUT(src[i + 2]);
+            ENCODE_FLUSH();
+            ENCODE_PUT(src[i + 3]);
+            ENCODE_FLUSH();
+        }
+    }
+    // Hand the leftover bits to the writer, which finishes the tail
+    writer->bytes = (size_t)(out - writer->out);
+    writer->bitBuffer = accumulator;
+    writer->bitCount = pending;
+    return i;
+}
+
+// encodeWithCodes(), also adding the bytes to the four `counts` tables when they are not NULL
+static uint64_t encodeAndCount(const HuffmanCode codes[256], const unsigned char *src, size_t size, unsigned char *out,
+                               uint32_t counts[][256]) {
+    BitWriter writer;
+    bitWriterInit(&writer, out);
+
+    // Up to 63 bits fit between flushes and at most 7 are left after one, so the longest code in use decides
+    // how many codes can go in at a time
+    unsigned longest = 0;
+    for (int i = 0; i < 256; i++) {
+        longest = codes[i].length > longest ? codes[i].length : longest;
+    }
+    size_t i;
+    if (counts == NULL) {
+        if (longest <= 14) {
+            i = encodeFast(codes, src, size, 4, NULL, &writer);
+        } else if (longest <= 28) {
+            i = encodeFast(codes, src, size, 2, NULL, &writer);
+        } else {
+            i = encodeFast(codes, src, size, 1, NULL, &writer);
+        }
+    } else {
+        if (longest <= 14) {
+            i = encodeFast(codes, src, size, 4, counts, &writer);
+        } else if (longest <= 28) {
+            i = encodeFast(codes, src, size, 2, counts, &writer);
+        } else {
+            i = encodeFast(codes, src, size, 1, counts, &writer);
+        }
+    }
+    for (; i < size; i++) {
+        const HuffmanCode *code = &codes[src[i]];
+        bitWriterPut(&writer, code->code, code->length);
+        if (counts != NULL) {
+            counts[0][src[i]]++;
+        }
+    }
+    return bitWriterFinish(&writer);
+}
+
+uint64_t encodeWithCodes(const HuffmanCode codes[256], const unsigned char *src, size_t size, unsigned char *out) {
+    return encodeAndCount(codes, src, size, out, NULL);
+}
+
+size_t encodeStreams(const HuffmanCode codes[256], const unsigned char *src, size_t size, int streamCount, unsigned char *out,
+                     uint64_t streamBits[]) {
+    size_t segment = HUF_STREAM_SEGMENT(size, streamCount);
+    size_t bytes = 0;
+    for (int s = 0; s < streamCount; s++) {
+        size_t start = (size_t)s * segment < size ? (size_t)s * segment : size;
+        size_t length = size - start < segment ? size - start : segment;
+        streamBits[s] = encodeWithCodes(codes, src + start, length, out + bytes);
+        bytes += (size_t)((streamBits[s] + 7) / 8);
+    }
+    return bytes;
+}
+
+size_t encodeStreamsCounting(const HuffmanCode codes[256], const unsigned char *src, size_t size, int streamCount,
+                             unsigned char *out, uint64_t streamBits[], uint64_t counts[256]) {
+    // Four tables, one per byte of a step, so consecutive equal bytes do not wait on each other's increments
+    uint32_t tables[4][256];
+    memset(tables, 0, sizeof tables);
+    size_t segment = HUF_STREAM_SEGMENT(size, streamCount);
+    size_t bytes = 0;
+    for (int s = 0; s < streamCount; s++) {
+        size_t start = (size_t)s * segment < size ? (size_t)s * segment : size;
+        size_t length = size - start < segment ? size - start : segment;
+        streamBits[s] = encodeAndCount(codes, src + start, length, out + bytes, tables);
+        bytes += (size_t)((streamBits[s] + 7) / 8);
+    }
+    for (int symbol = 0; symbol < 256; symbol++) {
+        counts[symbol] = (uint64_t)tables[0][symbol] + tables[1][symbol] + tables[2][symbol] + tables[3][symbol];
+    }
+    return bytes;
+}
+
+size_t compressCanonical(const char *filename, unsigned char *compressed, unsigned maxCodeLength, uint64_t *bitLength) {
+    // One mapping serves both the count and the encode, so the file is read once
+    InputFile input;
+    if (openInputFile(&input, filename) != 0) {
+        return 0;
+    }
+    node_t nodes[256];
+    int uniqueCount = 0;
+    countBufferFrequencies(input.data, input.size, nodes, &uniqueCount);
+
+    uint8_t lengths[256];
+    int status;
+    if (maxCodeLength > 0) {
+        status = limitedCodeLengths(nodes, uniqueCount, maxCodeLength, lengths);
+    } else {
+        // The tree is only needed for the lengths, so it is built in an arena and dropped before encoding
+        HuffmanArena arena;
+        for (int i = 0; i < 256; i++) {
+            lengths[i] = 0;
+        }
+        status = initArena(&arena, 256);
+        if (status == 0 && uniqueCount > 0) {
+            status = arenaCodeLengths(&arena, arenaBuildTree(&arena, nodes, uniqueCount), lengths);
+        }
+        freeArena(&arena);
+    }
+
+    HuffmanCode codes[256];
+    if (status != 0 || canonicalCodes(lengths, codes) != 0) {
+        closeInputFile(&input);
+        return 0;
+    }
+    size_t headerBytes = writeCodeLengthHeader(lengths, compressed);
+    *bitLength = encodeWithCodes(codes, input.data, input.size, compressed + headerBytes);
+    closeInputFile(&input);
+    return headerBytes + (size_t)((*bitLength + 7) / 8);
+}
+
+size_t decompressCanonical(const unsigned char *compressed, size_t size, uint64_t bitLength, char *decompressed,
+                           size_t capacity) {
+    uint8_t lengths[256];
+    HuffmanCode codes[256];
+    long headerBytes = readCodeLengthHeader(compressed, size, lengths);
+    if (headerBytes < 0 || canonicalCodes(lengths, codes) != 0 ||
+        (bitLength + 7) / 8 > size - (size_t)headerBytes) {
+        return 0;
+    }
+
+    DecodeTable table;
+    if (buildDecodeTableFromCodes(&table, codes) != 0) {
+        return 0;
+    }
+    size_t decodedBytes = decodeWithTable(&table, compressed + headerBytes, bitLength, decompressed, capacity);
+    freeDecodeTable(&table);
+    return decodedBytes;
+}
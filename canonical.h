@@ -0,0 +1,177 @@
+#ifndef CANONICAL_H
+#define CANONICAL_H
+/*****************************************************************************
+**
+* Filename: canonical.h
+*
+* Description:
+* Canonical Huffman mode. Only the code length of each symbol is kept from
+* the tree; the codes themselves are reassigned in canonical order (shorter
+* codes first, ties broken by symbol value), so encoder and decoder can
+* rebuild identical code tables from the 256 lengths alone. The lengths are
+* stored run-length coded in front of the payload, which makes the stream
+* decodable in a process that never saw the tree.
+*
+* Header format (one byte per item, until 256 lengths are known):
+* 0 - HUF_MAX_CODE_LENGTH - The code length of the next symbol.
+* 0x80 | (n - 1) - The previous length repeated for the next n symbols (1-128). Before the first literal the previous length is 0.
+*
+* Dependencies:
+* compress_and_decompress.h
+* decode_table.h
+*****************************************************************************/
+#include "compress_and_decompress.h"
+#include "decode_table.h"
+
+// Largest possible code-length header (one literal per symbol)
+#define CODE_LENGTH_HEADER_MAX 256
+
+/*****************************************************************************
+**
+* Function: codeLengthsFromTree
+*
+* Purpose:
+* Records the depth of every leaf of `root` in `lengths` (0 for symbols not
+* in the tree). A tree with a single leaf gives that symbol length 1.
+*
+* Returns:
+* int - 0 on success, -1 if a leaf is deeper than HUF_MAX_CODE_LENGTH.
+*****************************************************************************/
+int codeLengthsFromTree(HuffmanNode *root, uint8_t lengths[256]);
+
+/*****************************************************************************
+**
+* Function: limitedCodeLengths
+*
+* Purpose:
+* Computes optimal code lengths that never exceed `maxLength`, using the
+* package-merge algorithm on the counted frequencies (no tree is built).
+* When the limit is not binding the result is as short as a plain Huffman
+* code. Bounding the length keeps codes inside HuffmanCode and a 64-bit bit
+* buffer, and with maxLength <= DECODE_TABLE_BITS every code resolves in a
+* single table probe.
+*
+* Parameters:
+* nodes (const node_t*) - Symbols and weights, as filled in by countFrequencies().
+* count (int) - Number of entries in `nodes`.
+* maxLength (unsigned) - Longest code allowed (1-HUF_MAX_CODE_LENGTH).
+* lengths (uint8_t*) - Receives the length of each of the 256 symbols (0 if unused).
+*
+* Returns:
+* int - 0 on success, -1 if `maxLength` is out of range or too short for `count` symbols (2^maxLength < count), or memory allocation fails.
+*****************************************************************************/
+int limitedCodeLengths(const node_t nodes[], int count, unsigned maxLength, uint8_t lengths[256]);
+
+/*****************************************************************************
+**
+* Function: canonicalCodes
+*
+* Purpose:
+* Assigns canonical codes for the given lengths.
+*
+* Returns:
+* int - 0 on success, -1 if a length exceeds HUF_MAX_CODE_LENGTH or the lengths over-subscribe the code space (so no prefix code exists).
+*****************************************************************************/
+int canonicalCodes(const uint8_t lengths[256], HuffmanCode codes[256]);
+
+/*****************************************************************************
+**
+* Function: writeCodeLengthHeader / readCodeLengthHeader
+*
+* Purpose:
+* Serialize the 256 code lengths in the run-length format described above.
+* `out` must hold CODE_LENGTH_HEADER_MAX bytes.
+*
+* Returns:
+* writeCodeLengthHeader: size_t - Bytes written.
+* readCodeLengthHeader: long - Bytes consumed, or -1 if the header is truncated or malformed.
+*****************************************************************************/
+size_t writeCodeLengthHeader(const uint8_t lengths[256], unsigned char *out);
+long readCodeLengthHeader(const unsigned char *in, size_t size, uint8_t lengths[256]);
+
+/*****************************************************************************
+**
+* Function: encodeWithCodes
+*
+* Purpose:
+* Packs the code of each of the `size` bytes of `src` into `out`. Codes
+* go through a local 64-bit accumulator, four bytes per loop step, with
+* one word store for every four, two or one codes depending on the
+* longest code in the table; only the last few dozen bytes go through
+* bitWriterPut.
+*
+* Returns:
+* uint64_t - Bits written. `out` must hold (bits + 7) / 8 bytes.
+*****************************************************************************/
+uint64_t encodeWithCodes(const HuffmanCode codes[256], const unsigned char *src, size_t size, unsigned char *out);
+
+/*****************************************************************************
+**
+* Function: encodeStreams
+*
+* Purpose:
+* Splits `src` into `streamCount` segments (see HUF_STREAM_SEGMENT) and
+* packs each one as its own byte-aligned bit stream, back to back in `out`,
+* for decodeStreamsWithTable().
+*
+* Returns:
+* size_t - Bytes written; streamBits[i] receives the bit length of stream i.
+*****************************************************************************/
+size_t encodeStreams(const HuffmanCode codes[256], const unsigned char *src, size_t size, int streamCount, unsigned char *out,
+                     uint64_t streamBits[]);
+
+/*****************************************************************************
+**
+* Function: encodeStreamsCounting
+*
+* Purpose:
+* encodeStreams() that also counts the bytes it packs, so a block coded
+* with a table chosen in advance is read once rather than once to count
+* and once to encode. Bytes whose code has length 0 write nothing; the
+* counts show whether the table covered the input, and if it did not,
+* up to 8 bytes past the ones written may have been stored to. Segments
+* must be shorter than 4 GiB (the counts are 32-bit until they are
+* combined).
+*
+* Returns:
+* size_t - Bytes written; streamBits[i] receives the bit length of stream i and counts[b] the occurrences of byte b.
+*****************************************************************************/
+size_t encodeStreamsCounting(const HuffmanCode codes[256], const unsigned char *src, size_t size, int streamCount,
+                             unsigned char *out, uint64_t streamBits[], uint64_t counts[256]);
+
+/*****************************************************************************
+**
+* Function: compressCanonical
+*
+* Purpose:
+* Compresses a file in canonical mode: counts frequencies, derives the code
+* lengths, writes the code-length header to `compressed` and the packed
+* codes directly after it.
+*
+* Parameters:
+* filename (const char*) - The file to compress.
+* compressed (unsigned char*) - Output buffer for header and payload.
+* maxCodeLength (unsigned) - 0 takes the lengths from the Huffman tree, built in a HuffmanArena (failing if it is deeper than HUF_MAX_CODE_LENGTH); otherwise the lengths come from limitedCodeLengths() with this limit.
+* bitLength (uint64_t*) - Receives the payload length in bits.
+*
+* Returns:
+* size_t - Total bytes written (header plus payload), or 0 on error.
+*****************************************************************************/
+size_t compressCanonical(const char *filename, unsigned char *compressed, unsigned maxCodeLength, uint64_t *bitLength);
+
+/*****************************************************************************
+**
+* Function: decompressCanonical
+*
+* Purpose:
+* Reads the code-length header, rebuilds the decode table from it without
+* building a tree, and decodes `bitLength` payload bits into the
+* `capacity` bytes at `decompressed`.
+*
+* Returns:
+* size_t - Bytes written to `decompressed` (0 if the header is invalid). Decoding stops early, with an error, at an invalid code or a full buffer.
+*****************************************************************************/
+size_t decompressCanonical(const unsigned char *compressed, size_t size, uint64_t bitLength, char *decompressed,
+                           size_t capacity);
+
+#endif //CANONICAL_H
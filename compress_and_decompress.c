@@ -1,178 +1,421 @@
-//
-// Created by Cameron Brewster on 2024-11-20.
-//
-#include <stddef.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include "compress_and_decompress.h"
-#include <string.h>
-
-
-HuffmanNode *createLeafNode(char data, int frequency) {
-    HuffmanNode * newNode = (HuffmanNode*)malloc(sizeof(HuffmanNode)); // Allocating memory
-    if(newNode == NULL) {
-        printf("Memory allocation failed");
-        exit(EXIT_FAILURE); //Edge case if memory allocation fails
-    }
-
-    newNode -> frequency = frequency;
-    newNode -> data = data;
-    newNode -> left = NULL;
-    newNode -> right =NULL; // Initializing leaf node
-    return newNode;
-
-}
-
-HuffmanNode *createInternalNodes(HuffmanNode *left, HuffmanNode *right) {
-    HuffmanNode *newNode = (HuffmanNode*)malloc(sizeof(HuffmanNode)); // allocating memory for internal node
-    if(newNode == NULL) {
-        printf("Memory allocation failed");
-        exit(EXIT_FAILURE);  //Edge case if memory allocation fails
-    }
-    newNode -> frequency = left->frequency + right->frequency; // Setting the frequency to the sum of both its child nodes
-    newNode -> data = '\0'; // Internal nodes do not hold a character
-    newNode -> left = left; // Point to children
-    newNode -> right = right;
-
-    return newNode;
-}
-
-
-
-HuffmanNode* buildHuffmanTree(Queue* queue) {
-    while (queue->front != NULL && queue->front->next != NULL) {  // While more than one node in the queue
-
-        // Dequeue the two nodes with the smallest frequencies
-        HuffmanNode* left = priorityDequeue(queue);
-        HuffmanNode* right = priorityDequeue(queue);
-
-        // Create a new internal node
-        HuffmanNode* internalNode = createInternalNodes(left, right);
-
-        // Enqueue the new internal node back into the queue
-        priorityEnqueue(queue, internalNode);
-    }
-
-    // The final node left in the queue is the root of the Huffman tree
-    return priorityDequeue(queue);
-}
-
-    // Only one node should remain in the queue, which is the root of the Huffman tree
-
-void freeHuffmanTree(HuffmanNode* root) {
-    if(root == NULL) {
-        return; // Edge case if tree DNE
-    }
-    freeHuffmanTree(root->left); // Recusively calling left subtree
-    freeHuffmanTree(root->right); // Recursive calls to right subtree
-
-    free(root); // Freeing each node
-}
-void getCode(HuffmanNode *root, char codes[256][MAX], char* currentCode, int depth) {
-    if (root == NULL) { // Edge cse if tree DNE
-        return;
-    }
-    //If the node is a leaf node (no children)
-    if (root->left == NULL && root->right == NULL) {
-        currentCode[depth] = '\0';  // Adding a null character to the end of the string
-        strcpy(codes[(unsigned char)root->data], currentCode); //copying the code into a string
-        return;
-    }
-
-    // Traverse the left subtree
-    currentCode[depth] = '1';
-    // Note going left in the subtree should append 0; however our output is opposite if we append 0
-    // So we had to update this to append 1 going left in order to get the proper output
-    getCode(root->left, codes, currentCode, depth + 1); // Recursively calling left subtree
-
-    // Traverse the right subtree
-    // Appending 0 when travelling right
-    currentCode[depth] = '0';
-    getCode(root->right, codes, currentCode, depth + 1); // Recursively calling right subtree
-}
-
-void HuffmanCodes(HuffmanNode *root, char codes[256][MAX]) {
-    char currentCode[MAX] = {0};  // Initialize currentCode array to store the current code being generated
-
-    // Special case for when there is only one character (tree with only one node)
-    if (root != NULL && root->left == NULL && root->right == NULL) { //Edge case
-        currentCode[0] = '0';  //Assigning the single node to 0
-        codes[(unsigned char)root->data][0] = '0';
-        codes[(unsigned char)root->data][1] = '\0';  //handling the null character at the end of the string
-
-    } else {
-        getCode(root, codes, currentCode, 0);  //else getting codes from the getCode function
-    }
-}
-void compress(const char *filename, char *compressed, HuffmanNode *root, char codes[256][MAX]) {
-    FILE *file = fopen(filename, "r"); // Edge case if the file cannot be opened
-    if (file == NULL) {
-        printf("Error: Unable to open file '%s'\n", filename);
-        exit(1);
-    }
-
-    int j = 0;
-    int c;
-    while ((c = fgetc(file)) != EOF) {//traversing the file one character at a time to get the code
-        char *code = codes[(unsigned char)c]; //adding the code to the string
-
-
-        for (int k = 0; code[k] != '\0'; k++) { //Appending the code to the array
-            compressed[j++] = code[k];  // storing each character as a 0 or 1 in the array
-        }
-    }
-
-
-    compressed[j] = '\0';  //Adding a null character
-    fclose(file); // Closing the file
-}
-
-void decompress(const char *compressed, char *decompressed, HuffmanNode *root) {
-    if (root == NULL) { // If the huffman tree for the certain code frequencies DNE
-        printf("Error: Huffman Tree is empty!\n");
-        return;
-    }
-
-
-    if (root->left == NULL && root->right == NULL) {//Tree only has one node
-
-        int index = 0;
-        while (compressed[index] != '\0') {//traversing the compressed string
-            decompressed[index] = root->data;  //append the character
-            index++;
-        }
-        decompressed[index] = '\0'; //adding a null character
-        printf("Decompressed Data: %s\n", decompressed);
-        return;
-    }
-
-
-    int index = 0;  // pointer to compressed string
-    int decompressedIndex = 0;  //pointer into decompressed string
-    HuffmanNode *currentNode = root; //start from root of tree to decode
-
-    // Traverse the compressed binary string
-    while (compressed[index] != '\0') {// Traversing to the end of the compressed encoded string
-        // Traverse the tree based on the current bit (0 or 1)
-        if (compressed[index] == '1') { //If the compressed is a one go left
-            // Note: Again this is opposite as it should go right if it reads a 1 however our output has been backwards
-            currentNode = currentNode->left;
-        } else if (compressed[index] == '0') {
-            //The opposite going right if reading 0
-            currentNode = currentNode->right;
-        } else {
-            printf("Error: Invalid compressed data!\n");
-            return;
-        }
-
-        //Leaf node reached (a character)
-        if (currentNode->left == NULL && currentNode->right == NULL) {
-            decompressed[decompressedIndex++] = currentNode->data;  // Add the character to the decompressed string
-            currentNode = root;  // Reset to the root of the tree to decode the next character
-        }
-
-        index++;// Move to the next index of the encoded string
-    }
-
-    decompressed[decompressedIndex] = '\0';  //Add a null character to the end of the de-coded string
+//
+// Created by Cameron Brewster on 2024-11-20.
+//
+#include <stddef.h>
+#include <stdlib.h>
+#include "compress_and_decompress.h"
+#include "bit_io.h"
+#include "canonical.h"
+#include "decode_table.h"
+#include "file_input.h"
+#include "histogram.h"
+#include "huf_stats.h"
+#include <string.h>
+
+
+HuffmanNode *createLeafNode(char data, uint64_t frequency) {
+    HuffmanNode * newNode = (HuffmanNode*)malloc(sizeof(HuffmanNode)); // Allocating memory
+    if(newNode == NULL) {
+        return NULL; //Edge case if memory allocation fails
+    }
+    HUF_STATS_ADD(nodeAllocations, 1);
+
+    newNode -> frequency = frequency;
+    newNode -> data = data;
+    newNode -> left = NULL;
+    newNode -> right =NULL; // Initializing leaf node
+    return newNode;
+
+}
+
+HuffmanNode *createInternalNodes(HuffmanNode *left, HuffmanNode *right) {
+    HuffmanNode *newNode = (HuffmanNode*)malloc(sizeof(HuffmanNode)); // allocating memory for internal node
+    if(newNode == NULL) {
+        return NULL;  //Edge case if memory allocation fails
+    }
+    HUF_STATS_ADD(nodeAllocations, 1);
+    newNode -> frequency = left->frequency + right->frequency; // Setting the frequency to the sum of both its child nodes
+    newNode -> data = '\0'; // Internal nodes do not hold a character
+    newNode -> left = left; // Point to children
+    newNode -> right = right;
+
+    return newNode;
+}
+
+
+
+// Frees every tree still in the queue after a failed build, so the caller is left with an empty queue
+static void freeQueuedTrees(Queue* queue) {
+    while (queue->front != NULL) {
+        freeHuffmanTree(priorityDequeue(queue));
+    }
+}
+
+HuffmanNode* buildHuffmanTree(Queue* queue) {
+    HUF_STATS_TIMER(start);
+    while (queue->front != NULL && queue->front->next != NULL) {  // While more than one node in the queue
+
+        // Dequeue the two nodes with the smallest frequencies
+        HuffmanNode* left = priorityDequeue(queue);
+        HuffmanNode* right = priorityDequeue(queue);
+
+        // Create a new internal node
+        HuffmanNode* internalNode = createInternalNodes(left, right);
+        if (internalNode == NULL) {
+            freeHuffmanTree(left);
+            freeHuffmanTree(right);
+            freeQueuedTrees(queue);
+            return NULL;
+        }
+
+        // Enqueue the new internal node back into the queue
+        if (priorityEnqueue(queue, internalNode) != 0) {
+            freeHuffmanTree(internalNode);
+            freeQueuedTrees(queue);
+            return NULL;
+        }
+    }
+
+    // The final node left in the queue is the root of the Huffman tree
+    HuffmanNode* root = priorityDequeue(queue);
+    HUF_STATS_STAGE(HUF_STAGE_TREE, start);
+    return root;
+}
+
+    // Only one node should remain in the queue, which is the root of the Huffman tree
+
+HuffmanNode* buildHuffmanTreeHeap(MinHeap* heap) {
+    if (heap->size == 0) {
+        return NULL;
+    }
+    HUF_STATS_TIMER(start);
+    while (heap->size > 1) {  // Same merge loop as buildHuffmanTree, with O(log n) heap operations
+        HuffmanNode* left = heapPop(heap);
+        HuffmanNode* right = heapPop(heap);
+        HuffmanNode* internalNode = createInternalNodes(left, right);
+        if (internalNode == NULL) {
+            freeHuffmanTree(left);
+            freeHuffmanTree(right);
+            while (heap->size > 0) {
+                freeHuffmanTree(heapPop(heap));
+            }
+            return NULL;
+        }
+        heapPush(heap, internalNode); // Cannot fail: two nodes were just popped
+    }
+    HuffmanNode* root = heapPop(heap);
+    HUF_STATS_STAGE(HUF_STAGE_TREE, start);
+    return root;
+}
+
+HuffmanNode* buildHuffmanTreeSorted(HuffmanNode* leaves[], int count) {
+    if (count <= 0) {
+        return NULL;
+    }
+    HUF_STATS_TIMER(start);
+
+    // Internal nodes are created in non-decreasing frequency order, so a plain FIFO array keeps them sorted
+    HuffmanNode** internal = (HuffmanNode**)malloc((size_t)count * sizeof(HuffmanNode*));
+    if (internal == NULL) {
+        return NULL;
+    }
+    int leafFront = 0;
+    int internalFront = 0;
+    int internalRear = 0;
+
+    for (int merges = 0; merges < count - 1; merges++) {
+        HuffmanNode* smallest[2];
+        for (int k = 0; k < 2; k++) { // Take the smaller front of the two queues, preferring leaves on ties
+            if (internalFront == internalRear ||
+                (leafFront < count && leaves[leafFront]->frequency <= internal[internalFront]->frequency)) {
+                smallest[k] = leaves[leafFront++];
+            } else {
+                smallest[k] = internal[internalFront++];
+            }
+        }
+        internal[internalRear] = createInternalNodes(smallest[0], smallest[1]);
+        if (internal[internalRear] == NULL) {
+            // The leaves stay the caller's; only the internal nodes made here are released
+            for (int k = 0; k < internalRear; k++) {
+                free(internal[k]);
+            }
+            free(internal);
+            return NULL;
+        }
+        internalRear++;
+    }
+
+    HuffmanNode* root = count == 1 ? leaves[0] : internal[internalRear - 1];
+    free(internal);
+    HUF_STATS_STAGE(HUF_STAGE_TREE, start);
+    return root;
+}
+
+void freeHuffmanTree(HuffmanNode* root) {
+    if(root == NULL) {
+        return; // Edge case if tree DNE
+    }
+    freeHuffmanTree(root->left); // Recusively calling left subtree
+    freeHuffmanTree(root->right); // Recursive calls to right subtree
+
+    free(root); // Freeing each node
+}
+void getCode(HuffmanNode *root, char codes[256][MAX], char* currentCode, int depth) {
+    if (root == NULL) { // Edge cse if tree DNE
+        return;
+    }
+    if (depth >= MAX) { // The code would not fit in codes[] (see limitedCodeLengths() in canonical.h for bounded codes)
+        return;
+    }
+    //If the node is a leaf node (no children)
+    if (root->left == NULL && root->right == NULL) {
+        currentCode[depth] = '\0';  // Adding a null character to the end of the string
+        strcpy(codes[(unsigned char)root->data], currentCode); //copying the code into a string
+        return;
+    }
+
+    // Traverse the left subtree
+    currentCode[depth] = '1';
+    // Note going left in the subtree should append 0; however our output is opposite if we append 0
+    // So we had to update this to append 1 going left in order to get the proper output
+    getCode(root->left, codes, currentCode, depth + 1); // Recursively calling left subtree
+
+    // Traverse the right subtree
+    // Appending 0 when travelling right
+    currentCode[depth] = '0';
+    getCode(root->right, codes, currentCode, depth + 1); // Recursively calling right subtree
+}
+
+void HuffmanCodes(HuffmanNode *root, char codes[256][MAX]) {
+    char currentCode[MAX] = {0};  // Initialize currentCode array to store the current code being generated
+    HUF_STATS_TIMER(start);
+
+    // Special case for when there is only one character (tree with only one node)
+    if (root != NULL && root->left == NULL && root->right == NULL) { //Edge case
+        currentCode[0] = '0';  //Assigning the single node to 0
+        codes[(unsigned char)root->data][0] = '0';
+        codes[(unsigned char)root->data][1] = '\0';  //handling the null character at the end of the string
+
+    } else {
+        getCode(root, codes, currentCode, 0);  //else getting codes from the getCode function
+    }
+    HUF_STATS_STAGE(HUF_STAGE_CODES, start);
+}
+
+#ifdef HUF_STATS
+// Instrumented builds count the input a second time, to compare the string codes with its entropy
+static void recordStringCodes(const unsigned char *data, size_t size, char codes[256][MAX]) {
+    uint64_t counts[256] = {0};
+    uint8_t lengths[256] = {0};
+    if (hufStatsCurrent() == NULL) {
+        return;
+    }
+    countHistogram(data, size, counts);
+    for (int i = 0; i < 256; i++) {
+        lengths[i] = counts[i] > 0 ? (uint8_t)strlen(codes[i]) : 0;
+    }
+    HUF_STATS_CODES(counts, lengths);
+}
+#endif
+// Turns a '0'/'1' code string into an integer code, handed to the writer 32 bits at a time
+static void putStringCode(BitWriter *writer, const char *code) {
+    uint64_t bits = 0;
+    unsigned length = 0;
+    for (int k = 0; code[k] != '\0'; k++) {
+        bits = (bits << 1) | (uint64_t)(code[k] == '1');
+        if (++length == 32) {
+            bitWriterPut(writer, bits, length);
+            bits = 0;
+            length = 0;
+        }
+    }
+    if (length > 0) {
+        bitWriterPut(writer, bits, length);
+    }
+}
+
+// Turns the '0'/'1' strings into integer codes once, so the encoder reads a 2 KiB table instead of walking strings in
+// the 64 KiB codes[][] array for every byte. Returns -1 if a code is longer than HUF_MAX_CODE_LENGTH.
+static int packStringCodes(char codes[256][MAX], HuffmanCode packed[256]) {
+    for (int symbol = 0; symbol < 256; symbol++) {
+        uint32_t code = 0;
+        unsigned length = 0;
+        for (const char *bit = codes[symbol]; *bit != '\0'; bit++) {
+            if (length == HUF_MAX_CODE_LENGTH) {
+                return -1;
+            }
+            code = (code << 1) | (uint32_t)(*bit == '1');
+            length++;
+        }
+        packed[symbol].code = code;
+        packed[symbol].length = (uint8_t)length;
+    }
+    return 0;
+}
+
+// Encodes with the packed table when there is one (see encodeWithCodes()), or one code string at a time
+static uint64_t encodeStringCodes(const unsigned char *data, size_t size, unsigned char *out, char codes[256][MAX],
+                                  const HuffmanCode *packed) {
+    if (packed != NULL) {
+        return encodeWithCodes(packed, data, size, out);
+    }
+    BitWriter writer;
+    bitWriterInit(&writer, out);
+    for (size_t i = 0; i < size; i++) {//traversing the input one character at a time to get the code
+        putStringCode(&writer, codes[data[i]]);
+    }
+    return bitWriterFinish(&writer); // Flushing the last partial word; the bit count is the real output length
+}
+
+uint64_t compress(const char *filename, unsigned char *compressed, HuffmanNode *root, char codes[256][MAX]) {
+    (void)root;
+    InputFile input;
+    if (openInputFile(&input, filename) != 0) { // Edge case if the file cannot be opened
+        return HUF_COMPRESS_ERROR;
+    }
+    uint64_t bits = compressBuffer(input.data, input.size, compressed, codes);
+    closeInputFile(&input);
+    return bits;
+}
+
+uint64_t compressBuffer(const unsigned char *data, size_t size, unsigned char *compressed, char codes[256][MAX]) {
+    HUF_STATS_TIMER(start);
+    HuffmanCode packed[256];
+    // Only trees deeper than HUF_MAX_CODE_LENGTH (very skewed inputs) keep the string path
+    int fast = packStringCodes(codes, packed) == 0;
+    uint64_t bits = encodeStringCodes(data, size, compressed, codes, fast ? packed : NULL);
+    HUF_STATS_STAGE(HUF_STAGE_ENCODE, start);
+    HUF_STATS_ADD(blocksEncoded, 1);
+    HUF_STATS_ADD(encodeIn, size);
+    HUF_STATS_ADD(encodeOut, (bits + 7) / 8);
+    HUF_STATS_ADD(codedBits, bits);
+#ifdef HUF_STATS
+    recordStringCodes(data, size, codes);
+#endif
+    return bits;
+}
+
+size_t decompress(const unsigned char *compressed, uint64_t bitLength, char *decompressed, size_t capacity,
+                  HuffmanNode *root) {
+    DecodeTable table;
+    if (root == NULL || buildDecodeTable(&table, root) != 0) {
+        // Reports the error, or decodes without a table
+        return decompressTreeWalk(compressed, bitLength, decompressed, capacity, root);
+    }
+    HUF_STATS_TIMER(start);
+    size_t decodedBytes = decodeWithTable(&table, compressed, bitLength, decompressed, capacity);
+    freeDecodeTable(&table);
+    HUF_STATS_STAGE(HUF_STAGE_DECODE, start);
+    HUF_STATS_ADD(blocksDecoded, 1);
+    HUF_STATS_ADD(decodeIn, (bitLength + 7) / 8);
+    HUF_STATS_ADD(decodeOut, decodedBytes);
+    return decodedBytes;
+}
+
+size_t compressStreams(const char *filename, unsigned char *compressed, char codes[256][MAX], int streamCount,
+                       uint64_t streamBits[], size_t *size) {
+    *size = 0;
+    if (streamCount < 1 || streamCount > HUF_MAX_STREAMS) {
+        return 0;
+    }
+    // The segments are cut by position, so the whole file is mapped (or read) first
+    InputFile input;
+    if (openInputFile(&input, filename) != 0) {
+        return 0;
+    }
+    const unsigned char *data = input.data;
+    *size = input.size;
+
+    HUF_STATS_TIMER(encodeStart);
+    HuffmanCode packed[256];
+    int fast = packStringCodes(codes, packed) == 0;
+    size_t segment = HUF_STREAM_SEGMENT(*size, streamCount);
+    size_t bytes = 0;
+    for (int s = 0; s < streamCount; s++) {
+        size_t start = (size_t)s * segment < *size ? (size_t)s * segment : *size;
+        size_t end = *size - start < segment ? *size : start + segment;
+        streamBits[s] = encodeStringCodes(data + start, end - start, compressed + bytes, codes, fast ? packed : NULL);
+        bytes += (size_t)((streamBits[s] + 7) / 8);
+        HUF_STATS_ADD(codedBits, streamBits[s]);
+    }
+    HUF_STATS_STAGE(HUF_STAGE_ENCODE, encodeStart);
+    HUF_STATS_ADD(blocksEncoded, 1);
+    HUF_STATS_ADD(encodeIn, *size);
+    HUF_STATS_ADD(encodeOut, bytes);
+#ifdef HUF_STATS
+    recordStringCodes(data, *size, codes);
+#endif
+    closeInputFile(&input);
+    return bytes;
+}
+
+int decompressStreams(const unsigned char *compressed, const uint64_t streamBits[], int streamCount, char *decompressed,
+                      size_t size, HuffmanNode *root) {
+    DecodeTable table;
+    if (root == NULL || buildDecodeTable(&table, root) != 0) {
+        return -1;
+    }
+    HUF_STATS_TIMER(start);
+    int status = decodeStreamsWithTable(&table, compressed, streamBits, streamCount, decompressed, size);
+    freeDecodeTable(&table);
+    HUF_STATS_STAGE(HUF_STAGE_DECODE, start);
+    HUF_STATS_ADD(blocksDecoded, 1);
+    for (int s = 0; s < streamCount; s++) {
+        HUF_STATS_ADD(decodeIn, (streamBits[s] + 7) / 8);
+    }
+    HUF_STATS_ADD(decodeOut, status == 0 ? size : 0);
+    return status;
+}
+
+size_t decompressTreeWalk(const unsigned char *compressed, uint64_t bitLength, char *decompressed, size_t capacity,
+                          HuffmanNode *root) {
+    if (root == NULL) { // If the huffman tree for the certain code frequencies DNE
+        return 0;
+    }
+    HUF_STATS_TIMER(start);
+    HUF_STATS_ADD(blocksDecoded, 1);
+    HUF_STATS_ADD(decodeIn, (bitLength + 7) / 8);
+
+
+    if (root->left == NULL && root->right == NULL) {//Tree only has one node
+        // Every symbol is the single 1-bit code, so the bit length is the symbol count
+        size_t index;
+        for (index = 0; index < bitLength && index < capacity; index++) {
+            decompressed[index] = root->data;  //append the character
+        }
+        HUF_STATS_STAGE(HUF_STAGE_DECODE, start);
+        HUF_STATS_ADD(decodeOut, index);
+        return index;
+    }
+
+
+    BitReader reader;  // reads the packed bits written by compress()
+    bitReaderInit(&reader, compressed, bitLength);
+    size_t decompressedIndex = 0;  //pointer into decompressed string
+    HuffmanNode *currentNode = root; //start from root of tree to decode
+
+    // Traverse the compressed bit stream
+    while (reader.bitsLeft > 0) {// Traversing to the end of the encoded bits
+        // Traverse the tree based on the current bit (0 or 1)
+        if (bitReaderGetBit(&reader)) { //If the bit is a one go left
+            // Note: Again this is opposite as it should go right if it reads a 1 however our output has been backwards
+            currentNode = currentNode->left;
+        } else {
+            //The opposite going right if reading 0
+            currentNode = currentNode->right;
+        }
+
+        //Leaf node reached (a character)
+        if (currentNode->left == NULL && currentNode->right == NULL) {
+            if (decompressedIndex == capacity) { // More codes than the output can hold: the bits do not belong to this tree
+                break;
+            }
+            decompressed[decompressedIndex++] = currentNode->data;  // Add the character to the decompressed string
+            currentNode = root;  // Reset to the root of the tree to decode the next character
+        }
+    }
+
+    HUF_STATS_STAGE(HUF_STAGE_DECODE, start);
+    HUF_STATS_ADD(decodeOut, decompressedIndex);
+    return decompressedIndex;  // Number of decoded bytes
 }
\ No newline at end of file
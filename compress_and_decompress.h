@@ -1,48 +1,102 @@
-
-#define MAX 256
-#ifndef CAMO_H
-#define CAMO_H
-
-#endif //CAMO_H
-//
-// Created by Cameron Brewster on 2024-11-20.
-//
-// huffman_tree.h: Define the structure and operations for the Huffman Tree.
-// priority_queue.h: Define the priority queue for storing nodes.
-// compression.h: Functions for compressing files.
-// decompression.h: Functions for decompressing files.
-// file_utils.h: Utility functions for reading and writing files.
-
-
-
-#include "priority_queue.h"
-
-// Create a Tree data structure for the Huffman Nodes
-
-
-// A create node function
-HuffmanNode *createLeafNode(char data, int frequency);
-/* Parameters :
- a character to hold the node's symbol in tree
- an integer to hold the frequency associated with that character - Frequency of letters
- */
-
-
-
-HuffmanNode *createInternalNodes(HuffmanNode* left, HuffmanNode *right);
-
-
-HuffmanNode* buildHuffmanTree(Queue* queue);
-
-
-
-void getCode(HuffmanNode *root, char codes[256][MAX], char* currentCode, int depth);
-
-
-void freeHuffmanTree(HuffmanNode* root);
-
-void compress(const char *filename, char *compressed, HuffmanNode *root, char codes[256][MAX]);
-
-
-void decompress(const char *compressed, char *decompressed, HuffmanNode *root);
-void HuffmanCodes(HuffmanNode *root, char codes[256][MAX]);
\ No newline at end of file
+
+#define MAX 256
+#ifndef CAMO_H
+#define CAMO_H
+//
+// Created by Cameron Brewster on 2024-11-20.
+//
+// huffman_tree.h: Define the structure and operations for the Huffman Tree.
+// priority_queue.h: Define the priority queue for storing nodes.
+// compression.h: Functions for compressing files.
+// decompression.h: Functions for decompressing files.
+// file_utils.h: Utility functions for reading and writing files.
+
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include "priority_queue.h"
+
+// Longest code a HuffmanCode (and so a canonical code table) can hold
+#define HUF_MAX_CODE_LENGTH 32
+
+// A code in integer form: the low `length` bits of `code`, most significant bit first. Unused symbols have length 0.
+typedef struct {
+    uint32_t code;
+    uint8_t length;
+} HuffmanCode;
+
+// Multi-stream encoding splits the input into up to HUF_MAX_STREAMS equal segments, each coded as its own bit stream.
+// Every segment but the last holds HUF_STREAM_SEGMENT(size, count) bytes; the last holds the rest.
+#define HUF_MAX_STREAMS 8
+#define HUF_STREAM_SEGMENT(size, count) (((size) + (size_t)(count) - 1) / (size_t)(count))
+
+// Returned by compress() instead of a bit count when the input cannot be read
+#define HUF_COMPRESS_ERROR UINT64_MAX
+
+// Create a Tree data structure for the Huffman Nodes
+
+
+// A create node function
+HuffmanNode *createLeafNode(char data, uint64_t frequency);
+/* Parameters :
+ a character to hold the node's symbol in tree
+ an integer to hold the frequency associated with that character - Frequency of letters
+ Returns NULL if memory allocation fails; so does createInternalNodes.
+ */
+
+
+
+HuffmanNode *createInternalNodes(HuffmanNode* left, HuffmanNode *right);
+
+
+// The tree builders return NULL if a node cannot be allocated. buildHuffmanTree and buildHuffmanTreeHeap then free
+// every node they were given, leaving the queue or heap empty; buildHuffmanTreeSorted leaves `leaves` to the caller.
+HuffmanNode* buildHuffmanTree(Queue* queue);
+
+// Builds the tree from the nodes in a MinHeap (see initHeap()): O(n log n) with no allocation besides the new nodes.
+HuffmanNode* buildHuffmanTreeHeap(MinHeap* heap);
+
+// Two-queue linear-time build for leaves already sorted by ascending frequency. `leaves` is left unchanged.
+HuffmanNode* buildHuffmanTreeSorted(HuffmanNode* leaves[], int count);
+
+
+
+void getCode(HuffmanNode *root, char codes[256][MAX], char* currentCode, int depth);
+
+
+void freeHuffmanTree(HuffmanNode* root);
+
+// Packs the code of every byte in the file into `compressed` and returns the number of bits written.
+// `compressed` must hold (bits + 7) / 8 bytes; it is not NUL-terminated.
+// The file is memory-mapped (see file_input.h) rather than read one character at a time.
+// The codes are packed into an integer table once and written through a 64-bit accumulator (see encodeWithCodes()).
+// Returns HUF_COMPRESS_ERROR if the file cannot be read.
+uint64_t compress(const char *filename, unsigned char *compressed, HuffmanNode *root, char codes[256][MAX]);
+// Same as compress(), for input already in memory: a caller that maps the file once with openInputFile() can pass the
+// same buffer to countBufferFrequencies() and here, reading the input in a single pass.
+uint64_t compressBuffer(const unsigned char *data, size_t size, unsigned char *compressed, char codes[256][MAX]);
+
+
+// Decodes `bitLength` bits produced by compress() and returns the number of bytes written to `decompressed`, which
+// holds `capacity` bytes. Decoding stops early when the output is full while bits remain, so corrupt or mismatched
+// input cannot overrun the buffer. Nothing is printed: the caller compares the count with the size it expects.
+// Builds a DecodeTable from the tree (see decode_table.h) and decodes several bits per lookup.
+size_t decompress(const unsigned char *compressed, uint64_t bitLength, char *decompressed, size_t capacity,
+                  HuffmanNode *root);
+
+// Multi-stream variant of compress(): reads the whole file, splits it into `streamCount` (1 - HUF_MAX_STREAMS)
+// segments and writes each segment's codes as a byte-aligned bit stream, back to back. Each stream's bit count
+// goes to `streamBits` and the file's size to `size`. Returns the bytes written to `compressed`, or 0 on error.
+size_t compressStreams(const char *filename, unsigned char *compressed, char codes[256][MAX], int streamCount,
+                       uint64_t streamBits[], size_t *size);
+// Decodes the output of compressStreams() into the `size` bytes at `decompressed`, running the streams' decode
+// chains interleaved on one thread. Returns 0 on success, -1 if any stream is invalid or does not fill its segment.
+int decompressStreams(const unsigned char *compressed, const uint64_t streamBits[], int streamCount, char *decompressed,
+                      size_t size, HuffmanNode *root);
+// Reference decoder: same contract as decompress(), following one tree pointer per bit.
+size_t decompressTreeWalk(const unsigned char *compressed, uint64_t bitLength, char *decompressed, size_t capacity,
+                          HuffmanNode *root);
+void HuffmanCodes(HuffmanNode *root, char codes[256][MAX]);
+
+#endif //CAMO_H
\ No newline at end of file
@@ -0,0 +1,405 @@
+#include <math.h>
+#include <stdlib.h>
+#include "context_model.h"
+#include "bit_io.h"
+#include "block_codec.h"
+#include "canonical.h"
+#include "decode_table.h"
+
+/*****************************************************************************
+**
+* Filename: context_model.c
+*
+* Description:
+* Byte-pair counting, context clustering, the order-1 header, and the
+* order-1 stream encoder and decoder.
+*
+* Dependencies:
+* math.h
+* stdlib.h
+* context_model.h
+* bit_io.h
+* block_codec.h
+* canonical.h
+* decode_table.h
+*****************************************************************************/
+
+#define ORDER1_ITERATIONS 4
+
+// Input bytes per code table the planner aims for, so short blocks do not pay for tables they cannot fill
+#define ORDER1_BYTES_PER_TABLE 2048
+
+// A context and how many bytes follow it, for ranking the contexts
+typedef struct {
+    uint64_t total;
+    int context;
+} ContextRank;
+
+static int compareByTotal(const void *a, const void *b) {
+    const ContextRank *x = a;
+    const ContextRank *y = b;
+    if (x->total != y->total) {
+        return x->total < y->total ? 1 : -1;
+    }
+    return x->context - y->context;
+}
+
+// The byte pairs of `src` as the streams see them: every segment starts after a 0 byte
+static void countPairs(const unsigned char *src, size_t size, int streamCount, uint32_t pairs[256 * 256]) {
+    size_t segment = HUF_STREAM_SEGMENT(size, streamCount);
+    for (size_t start = 0; start < size; start += segment) {
+        size_t end = size - start < segment ? size : start + segment;
+        unsigned previous = 0;
+        for (size_t i = start; i < end; i++) {
+            pairs[previous << 8 | src[i]]++;
+            previous = src[i];
+        }
+    }
+}
+
+// Estimated bytes for an ideal order-1 code with a table per context: the conditional entropy of the pairs, plus
+// half a log2(total) bits per byte a context was seen followed by (the usual MDL price of its statistics, without
+// which contexts seen a few hundred times look predictable even in random data)
+static double estimateOrder1Bytes(const uint32_t pairs[256 * 256]) {
+    double bits = 0;
+    for (int context = 0; context < 256; context++) {
+        uint64_t total = 0;
+        int distinct = 0;
+        for (int symbol = 0; symbol < 256; symbol++) {
+            uint32_t count = pairs[context << 8 | symbol];
+            if (count > 1) {
+                bits -= count * log2(count);
+            }
+            total += count;
+            distinct += count != 0;
+        }
+        if (total > 1) {
+            bits += (total + 0.5 * (distinct - 1)) * log2((double)total);
+        }
+    }
+    return bits / 8;
+}
+
+// Estimated bits per byte of each table: the length an ideal code would give it, with a bit more for bytes the
+// table does not have yet
+static void tableCosts(const uint64_t histograms[][256], int tableCount, float costs[][256]) {
+    for (int table = 0; table < tableCount; table++) {
+        uint64_t total = 0;
+        for (int symbol = 0; symbol < 256; symbol++) {
+            total += histograms[table][symbol];
+        }
+        double scale = log2((double)total + 1);
+        for (int symbol = 0; symbol < 256; symbol++) {
+            costs[table][symbol] = (float)(scale - log2((double)histograms[table][symbol] + 0.5));
+        }
+    }
+}
+
+/*****************************************************************************
+**
+* Function: clusterContexts
+*
+* Purpose:
+* Groups the contexts that occur into at most `tableCount` tables. The
+* busiest contexts seed one table each; every context then moves to the
+* table that codes its bytes most cheaply, and the tables are recounted,
+* for ORDER1_ITERATIONS rounds. Tables left empty are dropped.
+*
+* Returns:
+* int - The number of tables used, or -1 if memory allocation fails.
+*****************************************************************************/
+static int clusterContexts(const uint32_t pairs[256 * 256], int tableCount, uint8_t contextTable[256],
+                           uint64_t histograms[HUF_ORDER1_MAX_TABLES][256]) {
+    ContextRank ranks[256];
+    int activeCount = 0;
+    int listStart[257];
+    int listSize = 0;
+    for (int context = 0; context < 256; context++) {
+        uint64_t total = 0;
+        listStart[context] = listSize;
+        for (int symbol = 0; symbol < 256; symbol++) {
+            total += pairs[context << 8 | symbol];
+            listSize += pairs[context << 8 | symbol] != 0;
+        }
+        if (total > 0) {
+            ranks[activeCount].total = total;
+            ranks[activeCount].context = context;
+            activeCount++;
+        }
+        contextTable[context] = 0;
+    }
+    listStart[256] = listSize;
+    qsort(ranks, (size_t)activeCount, sizeof(ContextRank), compareByTotal);
+    if (tableCount > activeCount) {
+        tableCount = activeCount > 0 ? activeCount : 1;
+    }
+
+    // Each context's non-zero counts, so the assignment rounds skip the bytes that never follow it
+    unsigned char *listSymbols = malloc((size_t)listSize + 1);
+    uint32_t *listCounts = malloc(((size_t)listSize + 1) * sizeof(uint32_t));
+    if (listSymbols == NULL || listCounts == NULL) {
+        free(listSymbols);
+        free(listCounts);
+        return -1;
+    }
+    for (int context = 0, item = 0; context < 256; context++) {
+        for (int symbol = 0; symbol < 256; symbol++) {
+            if (pairs[context << 8 | symbol] != 0) {
+                listSymbols[item] = (unsigned char)symbol;
+                listCounts[item++] = pairs[context << 8 | symbol];
+            }
+        }
+    }
+
+    for (int table = 0; table < tableCount; table++) {
+        int seed = activeCount > 0 ? ranks[table].context : 0;
+        contextTable[seed] = (uint8_t)table;
+        for (int symbol = 0; symbol < 256; symbol++) {
+            histograms[table][symbol] = pairs[seed << 8 | symbol];
+        }
+    }
+    float costs[HUF_ORDER1_MAX_TABLES][256];
+    for (int round = 0; round < ORDER1_ITERATIONS && tableCount > 1; round++) {
+        tableCosts(histograms, tableCount, costs);
+        for (int rank = 0; rank < activeCount; rank++) {
+            int context = ranks[rank].context;
+            float bestCost = 0;
+            for (int table = 0; table < tableCount; table++) {
+                float cost = 0;
+                for (int item = listStart[context]; item < listStart[context + 1]; item++) {
+                    cost += (float)listCounts[item] * costs[table][listSymbols[item]];
+                }
+                if (table == 0 || cost < bestCost) {
+                    bestCost = cost;
+                    contextTable[context] = (uint8_t)table;
+                }
+            }
+        }
+        for (int table = 0; table < tableCount; table++) {
+            for (int symbol = 0; symbol < 256; symbol++) {
+                histograms[table][symbol] = 0;
+            }
+        }
+        for (int context = 0; context < 256; context++) {
+            for (int item = listStart[context]; item < listStart[context + 1]; item++) {
+                histograms[contextTable[context]][listSymbols[item]] += listCounts[item];
+            }
+        }
+    }
+    free(listSymbols);
+    free(listCounts);
+
+    // Drop the tables no context chose, keeping the others in order
+    int renumber[HUF_ORDER1_MAX_TABLES];
+    int used = 0;
+    for (int table = 0; table < tableCount; table++) {
+        uint64_t total = 0;
+        for (int symbol = 0; symbol < 256; symbol++) {
+            total += histograms[table][symbol];
+        }
+        renumber[table] = total > 0 || table == 0 ? used : -1;
+        if (renumber[table] >= 0) {
+            for (int symbol = 0; symbol < 256 && used != table; symbol++) {
+                histograms[used][symbol] = histograms[table][symbol];
+            }
+            used++;
+        }
+    }
+    for (int context = 0; context < 256; context++) {
+        int table = renumber[contextTable[context]];
+        contextTable[context] = (uint8_t)(table >= 0 ? table : 0);
+    }
+    return used;
+}
+
+size_t planOrder1Model(HuffmanArena *arena, const unsigned char *src, size_t size, int streamCount, size_t limit,
+                       Order1Model *model) {
+    uint32_t *pairs = calloc(256 * 256, sizeof(uint32_t));
+    if (pairs == NULL) {
+        return 0;
+    }
+    countPairs(src, size, streamCount, pairs);
+    // Skip the clustering when even a table per context and the bare context map would not get under the limit
+    if (estimateOrder1Bytes(pairs) + 1 + 128 >= (double)limit) {
+        free(pairs);
+        return SIZE_MAX;
+    }
+    int tableCount = (int)(size / ORDER1_BYTES_PER_TABLE);
+    tableCount = tableCount < 1 ? 1 : tableCount > HUF_ORDER1_MAX_TABLES ? HUF_ORDER1_MAX_TABLES : tableCount;
+    uint64_t histograms[HUF_ORDER1_MAX_TABLES][256];
+    tableCount = clusterContexts(pairs, tableCount, model->contextTable, histograms);
+    free(pairs);
+    if (tableCount < 0) {
+        return 0;
+    }
+
+    // Each table gets its code the same way an order-0 block does
+    model->tableCount = tableCount;
+    uint64_t payloadBits = 0;
+    for (int table = 0; table < tableCount; table++) {
+        node_t nodes[256];
+        int count = 0;
+        for (int symbol = 0; symbol < 256; symbol++) {
+            if (histograms[table][symbol] > 0) {
+                nodes[count].index = symbol;
+                nodes[count].weight = histograms[table][symbol];
+                count++;
+            }
+        }
+        if (count == 0) {
+            // Only a context that never occurs can map here; give the table a valid one-symbol code
+            nodes[count].index = 0;
+            nodes[count].weight = 1;
+            count++;
+        }
+        if (blockCodeLengths(arena, nodes, count, model->lengths[table]) != 0 ||
+            canonicalCodes(model->lengths[table], model->codes[table]) != 0) {
+            return 0;
+        }
+        for (int symbol = 0; symbol < 256; symbol++) {
+            payloadBits += histograms[table][symbol] * model->lengths[table][symbol];
+        }
+    }
+
+    unsigned char header[1 + 128 + HUF_ORDER1_MAX_TABLES * CODE_LENGTH_HEADER_MAX];
+    return writeOrder1Header(model, header) + 1 + 5 * (size_t)streamCount + (size_t)(payloadBits / 8);
+}
+
+size_t writeOrder1Header(const Order1Model *model, unsigned char *out) {
+    size_t bytes = 0;
+    out[bytes++] = (unsigned char)model->tableCount;
+    for (int context = 0; context < 256; context += 2) {
+        out[bytes++] = (unsigned char)(model->contextTable[context] | model->contextTable[context + 1] << 4);
+    }
+    for (int table = 0; table < model->tableCount; table++) {
+        bytes += writeCodeLengthHeader(model->lengths[table], out + bytes);
+    }
+    return bytes;
+}
+
+long readOrder1Header(const unsigned char *in, size_t size, Order1Model *model) {
+    if (size < 1 + 128 || in[0] < 1 || in[0] > HUF_ORDER1_MAX_TABLES) {
+        return -1;
+    }
+    model->tableCount = in[0];
+    size_t bytes = 1;
+    for (int context = 0; context < 256; context += 2) {
+        model->contextTable[context] = in[bytes] & 0x0F;
+        model->contextTable[context + 1] = in[bytes++] >> 4;
+        if (model->contextTable[context] >= model->tableCount || model->contextTable[context + 1] >= model->tableCount) {
+            return -1;
+        }
+    }
+    for (int table = 0; table < model->tableCount; table++) {
+        long headerBytes = readCodeLengthHeader(in + bytes, size - bytes, model->lengths[table]);
+        if (headerBytes < 0) {
+            return -1;
+        }
+        // Every code must resolve in one primary probe; the decoder does not follow links
+        for (int symbol = 0; symbol < 256; symbol++) {
+            if (model->lengths[table][symbol] > HUF_BLOCK_MAX_CODE_LENGTH) {
+                return -1;
+            }
+        }
+        if (canonicalCodes(model->lengths[table], model->codes[table]) != 0) {
+            return -1;
+        }
+        bytes += (size_t)headerBytes;
+    }
+    return (long)bytes;
+}
+
+size_t encodeOrder1Streams(const Order1Model *model, const unsigned char *src, size_t size, int streamCount, unsigned char *out,
+                           uint64_t streamBits[]) {
+    const HuffmanCode *tables[256];
+    for (int context = 0; context < 256; context++) {
+        tables[context] = model->codes[model->contextTable[context]];
+    }
+    size_t segment = HUF_STREAM_SEGMENT(size, streamCount);
+    size_t bytes = 0;
+    for (int s = 0; s < streamCount; s++) {
+        size_t start = (size_t)s * segment < size ? (size_t)s * segment : size;
+        size_t end = size - start < segment ? size : start + segment;
+        BitWriter writer;
+        bitWriterInit(&writer, out + bytes);
+        unsigned previous = 0;
+        for (size_t i = start; i < end; i++) {
+            const HuffmanCode *code = &tables[previous][src[i]];
+            bitWriterPut(&writer, code->code, code->length);
+            previous = src[i];
+        }
+        streamBits[s] = bitWriterFinish(&writer);
+        bytes += (size_t)((streamBits[s] + 7) / 8);
+    }
+    return bytes;
+}
+
+// Decodes one byte of one stream with the table its previous byte selects; an invalid code clears `ok`
+#define ORDER1_STEP(s) do { \
+        bitReaderRefill(&readers[s]); \
+        const DecodeEntry *entry_ = &primaries[previous[s]][bitReaderPeek(&readers[s], DECODE_TABLE_BITS)]; \
+        if (entry_->count == 0 || entry_->firstLength > readers[s].bitsLeft) { \
+            ok = 0; \
+        } else { \
+            previous[s] = (unsigned char)entry_->value; \
+            *outs[s]++ = (unsigned char)previous[s]; \
+            bitReaderSkip(&readers[s], entry_->firstLength); \
+        } \
+    } while (0)
+
+int decodeOrder1Streams(const Order1Model *model, const unsigned char *compressed, const uint64_t streamBits[], int streamCount,
+                        unsigned char *decompressed, size_t size) {
+    DecodeTable tables[HUF_ORDER1_MAX_TABLES];
+    for (int table = 0; table < model->tableCount; table++) {
+        if (buildDecodeTableFromCodes(&tables[table], model->codes[table]) != 0) {
+            while (--table >= 0) {
+                freeDecodeTable(&tables[table]);
+            }
+            return -1;
+        }
+    }
+    const DecodeEntry *primaries[256];
+    for (int context = 0; context < 256; context++) {
+        primaries[context] = tables[model->contextTable[context]].entries;
+    }
+
+    BitReader readers[HUF_MAX_STREAMS];
+    unsigned char *outs[HUF_MAX_STREAMS];
+    unsigned char *ends[HUF_MAX_STREAMS];
+    unsigned previous[HUF_MAX_STREAMS];
+    size_t segment = HUF_STREAM_SEGMENT(size, streamCount);
+    size_t offset = 0;
+    for (int s = 0; s < streamCount; s++) {
+        size_t start = (size_t)s * segment < size ? (size_t)s * segment : size;
+        size_t end = size - start < segment ? size : start + segment;
+        bitReaderInit(&readers[s], compressed + offset, streamBits[s]);
+        offset += (size_t)((streamBits[s] + 7) / 8);
+        outs[s] = decompressed + start;
+        ends[s] = decompressed + end;
+        previous[s] = 0;
+    }
+
+    // The streams' chains are independent, so stepping each in turn keeps several table lookups in flight.
+    // The last segment is the shortest, so while it has room every stream does.
+    int ok = 1;
+    int last = streamCount - 1;
+    while (ok && outs[last] < ends[last]) {
+        for (int s = 0; s < streamCount && ok; s++) {
+            ORDER1_STEP(s);
+        }
+    }
+    for (int s = 0; s < streamCount && ok; s++) {
+        while (ok && outs[s] < ends[s]) {
+            ORDER1_STEP(s);
+        }
+        ok = ok && readers[s].bitsLeft == 0;
+    }
+
+    for (int table = 0; table < model->tableCount; table++) {
+        freeDecodeTable(&tables[table]);
+    }
+    if (!ok) {
+        return -1;
+    }
+    return 0;
+}
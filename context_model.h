@@ -0,0 +1,106 @@
+#ifndef CONTEXT_MODEL_H
+#define CONTEXT_MODEL_H
+/*****************************************************************************
+**
+* Filename: context_model.h
+*
+* Description:
+* Order-1 context modelling for the block codec. Instead of one code for
+* the whole block, each byte is coded with a table chosen by the byte
+* before it, so structured text and logs can get below their order-0
+* entropy. A table per previous byte would cost up to 256 code-length
+* headers per block, so the 256 contexts are clustered into at most
+* HUF_ORDER1_MAX_TABLES groups with similar statistics, and each group
+* shares one canonical code. The clustering is a few rounds of k-means
+* over the contexts' byte counts, seeded with the busiest contexts; each
+* group's code is built the same way as an order-0 block code.
+*
+* The block is split into bit streams like an order-0 block (see
+* block_codec.h). The first byte of every stream is coded as if it
+* followed a 0 byte, so the streams can still be decoded independently.
+*
+* Header format:
+* tableCount (1 byte) - Number of code tables (1 - HUF_ORDER1_MAX_TABLES).
+* context map (128 bytes) - The table of each previous byte value, 4 bits each, low nibble first.
+* code-length headers - One per table, in the format of canonical.h, with lengths of at most HUF_BLOCK_MAX_CODE_LENGTH.
+*
+* Dependencies:
+* compress_and_decompress.h
+* huffman_arena.h
+*****************************************************************************/
+#include "compress_and_decompress.h"
+#include "huffman_arena.h"
+
+#define HUF_ORDER1_MAX_TABLES 16
+
+// Blocks shorter than this are not worth modelling; the tables would outweigh the gain
+#define HUF_ORDER1_MIN_BLOCK_SIZE 4096
+
+/*****************************************************************************
+**
+* Structure: Order1Model
+*
+* Fields:
+* tableCount (int) - Code tables in use.
+* contextTable (uint8_t[]) - Table used after each previous byte value.
+* lengths (uint8_t[][]) - Code length of every byte in each table (0 if the table cannot code it).
+* codes (HuffmanCode[][]) - Canonical codes for `lengths`.
+*****************************************************************************/
+typedef struct {
+    int tableCount;
+    uint8_t contextTable[256];
+    uint8_t lengths[HUF_ORDER1_MAX_TABLES][256];
+    HuffmanCode codes[HUF_ORDER1_MAX_TABLES][256];
+} Order1Model;
+
+/*****************************************************************************
+**
+* Function: planOrder1Model
+*
+* Purpose:
+* Counts the byte pairs of `src` as the `streamCount` streams will see
+* them, clusters the contexts and builds a code for each cluster in
+* `arena`. The clustering is skipped when an estimate from the pairs'
+* conditional entropy shows the model would not come in under `limit`
+* bytes.
+*
+* Returns:
+* size_t - The size of the header, stream count, jump table and streams that encoding with the model would write (exact but for up to one byte of padding per stream), SIZE_MAX if the model was skipped, or 0 if memory allocation fails.
+*****************************************************************************/
+size_t planOrder1Model(HuffmanArena *arena, const unsigned char *src, size_t size, int streamCount, size_t limit,
+                       Order1Model *model);
+
+/*****************************************************************************
+**
+* Function: writeOrder1Header / readOrder1Header
+*
+* Purpose:
+* Serialize the model in the header format described above, and rebuild
+* it (codes included) from a header. writeOrder1Header returns the bytes
+* written.
+*
+* Returns:
+* readOrder1Header: long - Bytes consumed, or -1 if the header is truncated or malformed, or a table is not a prefix code within HUF_BLOCK_MAX_CODE_LENGTH bits.
+*****************************************************************************/
+size_t writeOrder1Header(const Order1Model *model, unsigned char *out);
+long readOrder1Header(const unsigned char *in, size_t size, Order1Model *model);
+
+/*****************************************************************************
+**
+* Function: encodeOrder1Streams / decodeOrder1Streams
+*
+* Purpose:
+* Same contract as encodeStreams() and decodeStreamsWithTable(), with each
+* byte coded by the table its predecessor selects. The decoder runs the
+* streams' decode chains interleaved, switching tables per byte.
+*
+* Returns:
+* encodeOrder1Streams: size_t - Bytes written; streamBits[i] receives the bit length of stream i.
+* decodeOrder1Streams: int - 0 if every stream decodes to exactly its segment, -1 otherwise.
+*****************************************************************************/
+size_t encodeOrder1Streams(const Order1Model *model, const unsigned char *src, size_t size, int streamCount, unsigned char *out,
+                           uint64_t streamBits[]);
+int decodeOrder1Streams(const Order1Model *model, const unsigned char *compressed, const uint64_t streamBits[], int streamCount,
+                        unsigned char *decompressed, size_t size);
+
+#endif //CONTEXT_MODEL_H
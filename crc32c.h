@@ -0,0 +1,34 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+/*****************************************************************************
+**
+* Filename: crc32c.h
+*
+* Description:
+* CRC-32C (Castagnoli) checksums for the block format. On x86 CPUs with
+* SSE4.2 (detected at run time) and on ARM builds with the CRC extension
+* the checksum uses the CPU's crc32 instructions, eight bytes at a time;
+* elsewhere it falls back to a byte-at-a-time table. Define HUF_NO_SSE42
+* to build only the table version on x86.
+*
+* Dependencies:
+* stddef.h
+* stdint.h
+*****************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+/*****************************************************************************
+**
+* Function: crc32c
+*
+* Purpose:
+* Extends `crc` with `size` bytes of `data`. Start with 0; the result of
+* one call can be passed as `crc` to the next to checksum data in pieces.
+*
+* Returns:
+* uint32_t - The CRC-32C of everything passed so far.
+*****************************************************************************/
+uint32_t crc32c(uint32_t crc, const void *data, size_t size);
+
+#endif //CRC32C_H
@@ -0,0 +1,425 @@
+#include <stdlib.h>
+#include <string.h>
+#include "decode_table.h"
+#include "bit_io.h"
+
+/*****************************************************************************
+**
+* Filename: decode_table.c
+*
+* Description:
+* Builds the DecodeTable from a list of (symbol, code, length) triples and
+* decodes packed bit streams with it. The codes are sorted by their
+* left-aligned value so that codes sharing a primary-table prefix are
+* contiguous; each such run gets its own subtable, recursively, so codes of
+* any length up to 64 bits can be resolved without walking the tree.
+*
+* Dependencies:
+* stdlib.h
+* string.h
+* decode_table.h
+* bit_io.h
+*****************************************************************************/
+
+typedef struct {
+    uint64_t code;
+    unsigned length;
+    unsigned symbol;
+} CodeWord;
+
+static uint64_t lowMask(unsigned bits) {
+    return bits >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << bits) - 1;
+}
+
+static int compareCodeWords(const void *a, const void *b) {
+    const CodeWord *x = a;
+    const CodeWord *y = b;
+    uint64_t left = x->code << (64 - x->length);
+    uint64_t right = y->code << (64 - y->length);
+    return (left > right) - (left < right);
+}
+
+// Appends `count` zeroed (unused) entries and returns the index of the first one, or -1
+static long reserveEntries(DecodeTable *table, size_t count) {
+    if (table->size + count > table->capacity) {
+        size_t capacity = table->capacity ? table->capacity : 1;
+        while (capacity < table->size + count) {
+            capacity *= 2;
+        }
+        DecodeEntry *grown = realloc(table->entries, capacity * sizeof(DecodeEntry));
+        if (grown == NULL) {
+            return -1;
+        }
+        table->entries = grown;
+        table->capacity = capacity;
+    }
+    size_t base = table->size;
+    memset(table->entries + base, 0, count * sizeof(DecodeEntry));
+    table->size += count;
+    return (long)base;
+}
+
+// Fills the table at `base` (indexed by `width` bits) with codes that share their first `consumed` bits
+static int fillTable(DecodeTable *table, size_t base, unsigned width, unsigned consumed, const CodeWord *codes, size_t count) {
+    size_t i = 0;
+    while (i < count) {
+        unsigned remaining = codes[i].length - consumed;
+        if (remaining <= width) {
+            // The code ends inside this table: it owns every index that starts with its bits
+            size_t first = (size_t)(codes[i].code & lowMask(remaining)) << (width - remaining);
+            size_t span = (size_t)1 << (width - remaining);
+            for (size_t k = 0; k < span; k++) {
+                DecodeEntry *entry = &table->entries[base + first + k];
+                entry->value = codes[i].symbol;
+                entry->length = (uint8_t)remaining;
+                entry->firstLength = (uint8_t)remaining;
+                entry->count = 1;
+            }
+            i++;
+            continue;
+        }
+
+        // Longer codes: gather the run sharing this table index and give it a subtable
+        size_t index = (size_t)((codes[i].code >> (remaining - width)) & lowMask(width));
+        size_t end = i;
+        unsigned longest = 0;
+        while (end < count) {
+            unsigned rest = codes[end].length - consumed;
+            if (rest <= width || (size_t)((codes[end].code >> (rest - width)) & lowMask(width)) != index) {
+                break;
+            }
+            if (codes[end].length > longest) {
+                longest = codes[end].length;
+            }
+            end++;
+        }
+        unsigned subWidth = longest - consumed - width;
+        if (subWidth > DECODE_TABLE_BITS) {
+            subWidth = DECODE_TABLE_BITS;
+        }
+        long subBase = reserveEntries(table, (size_t)1 << subWidth);
+        if (subBase < 0) {
+            return -1;
+        }
+        DecodeEntry *link = &table->entries[base + index];
+        link->value = (uint32_t)subBase;
+        link->length = (uint8_t)subWidth;
+        link->firstLength = 0;
+        link->count = 0;
+        if (fillTable(table, (size_t)subBase, subWidth, consumed + width, codes + i, end - i) != 0) {
+            return -1;
+        }
+        i = end;
+    }
+    return 0;
+}
+
+// Pairs each primary entry with the following symbol when both codes fit in the primary window
+static void pairPrimaryEntries(DecodeTable *table) {
+    size_t primarySize = (size_t)1 << DECODE_TABLE_BITS;
+    for (size_t index = 0; index < primarySize; index++) {
+        DecodeEntry *entry = &table->entries[index];
+        if (entry->count != 1 || entry->length >= DECODE_TABLE_BITS) {
+            continue;
+        }
+        unsigned spare = DECODE_TABLE_BITS - entry->length;
+        // The spare bits, left-aligned, select the entry for the next code; its first symbol is unaffected by pairing
+        const DecodeEntry *next = &table->entries[(index & lowMask(spare)) << entry->length];
+        if (next->count == 0 || next->firstLength > spare) {
+            continue;
+        }
+        entry->value |= (next->value & 0xFFFF) << 16;
+        entry->length = (uint8_t)(entry->length + next->firstLength);
+        entry->count = 2;
+    }
+}
+
+static int buildFromCodeWords(DecodeTable *table, CodeWord *codes, size_t count) {
+    table->entries = NULL;
+    table->size = 0;
+    table->capacity = 0;
+    table->maxLength = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (codes[i].length > table->maxLength) {
+            table->maxLength = codes[i].length;
+        }
+    }
+
+    qsort(codes, count, sizeof(CodeWord), compareCodeWords);
+    if (reserveEntries(table, (size_t)1 << DECODE_TABLE_BITS) < 0 ||
+        fillTable(table, 0, DECODE_TABLE_BITS, 0, codes, count) != 0) {
+        freeDecodeTable(table);
+        return -1;
+    }
+    pairPrimaryEntries(table);
+    return 0;
+}
+
+// Collects the code of every leaf, following the HuffmanCodes() convention of 1 for left and 0 for right
+static int collectCodes(HuffmanNode *node, uint64_t code, unsigned depth, CodeWord *codes, size_t *count) {
+    if (node->left == NULL && node->right == NULL) {
+        codes[*count].code = code;
+        codes[*count].length = depth;
+        codes[*count].symbol = (unsigned char)node->data;
+        (*count)++;
+        return 0;
+    }
+    if (depth == 64) {
+        return -1;
+    }
+    if (node->left != NULL && collectCodes(node->left, (code << 1) | 1, depth + 1, codes, count) != 0) {
+        return -1;
+    }
+    if (node->right != NULL && collectCodes(node->right, code << 1, depth + 1, codes, count) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int buildDecodeTable(DecodeTable *table, HuffmanNode *root) {
+    CodeWord codes[256];
+    size_t count = 0;
+
+    if (root == NULL) {
+        return -1;
+    }
+    if (root->left == NULL && root->right == NULL) {
+        // Single symbol: HuffmanCodes() assigns it the 1-bit code 0
+        codes[0].code = 0;
+        codes[0].length = 1;
+        codes[0].symbol = (unsigned char)root->data;
+        count = 1;
+    } else if (collectCodes(root, 0, 0, codes, &count) != 0) {
+        return -1;
+    }
+    return buildFromCodeWords(table, codes, count);
+}
+
+int buildDecodeTableFromCodes(DecodeTable *table, const HuffmanCode codes[256]) {
+    CodeWord words[256];
+    size_t count = 0;
+
+    for (unsigned symbol = 0; symbol < 256; symbol++) {
+        if (codes[symbol].length > 0) {
+            words[count].code = codes[symbol].code;
+            words[count].length = codes[symbol].length;
+            words[count].symbol = symbol;
+            count++;
+        }
+    }
+    return buildFromCodeWords(table, words, count);
+}
+
+// Follows link entries from the primary `entry`, consuming the bits of every table passed through
+static const DecodeEntry *resolveLink(const DecodeTable *table, BitReader *reader, const DecodeEntry *entry) {
+    unsigned width = DECODE_TABLE_BITS;
+    while (entry->count == 0) {
+        if (entry->length == 0 || reader->bitsLeft < width) {
+            return NULL; // Unused bit pattern, or the stream ends inside the code
+        }
+        bitReaderSkip(reader, width);
+        bitReaderRefill(reader);
+        width = entry->length;
+        entry = &table->entries[entry->value + bitReaderPeek(reader, width)];
+    }
+    return entry;
+}
+
+// Fast loop: four primary probes per refill. While more than `safeBits` bits remain every probe is a
+// whole code and at least one more symbol follows, so both bytes of an entry can be stored unconditionally.
+static size_t decodeFast(const DecodeTable *table, BitReader *reader, char *out, size_t room) {
+    const DecodeEntry *primary = table->entries;
+    uint64_t safeBits = 4 * DECODE_TABLE_BITS + table->maxLength;
+    char *start = out;
+    while (reader->bitsLeft > safeBits && room - (size_t)(out - start) >= 8) {
+        bitReaderRefill(reader);
+        for (int probe = 0; probe < 4; probe++) {
+            const DecodeEntry *entry = &primary[bitReaderPeek(reader, DECODE_TABLE_BITS)];
+            if (entry->count == 0) {
+                entry = resolveLink(table, reader, entry);
+                if (entry == NULL) {
+                    return (size_t)(out - start); // The tail reports the bad code
+                }
+                *out++ = (char)entry->value;
+                bitReaderSkip(reader, entry->length);
+                break; // resolveLink used up the refilled bits
+            }
+            out[0] = (char)entry->value;
+            out[1] = (char)(entry->value >> 16);
+            out += entry->count;
+            bitReaderSkip(reader, entry->length);
+        }
+    }
+    return (size_t)(out - start);
+}
+
+// Tail: checks every code against the bits and output space that are really left
+static size_t decodeTail(const DecodeTable *table, BitReader *reader, char *out, size_t room) {
+    const DecodeEntry *primary = table->entries;
+    char *start = out;
+    while (reader->bitsLeft > 0) {
+        bitReaderRefill(reader);
+        const DecodeEntry *entry = &primary[bitReaderPeek(reader, DECODE_TABLE_BITS)];
+        if (entry->count == 0) {
+            entry = resolveLink(table, reader, entry);
+        }
+        if (entry == NULL || entry->firstLength > reader->bitsLeft || (size_t)(out - start) == room) {
+            break;
+        }
+        *out++ = (char)entry->value;
+        if (entry->count == 2 && entry->length <= reader->bitsLeft && (size_t)(out - start) < room) {
+            *out++ = (char)(entry->value >> 16);
+            bitReaderSkip(reader, entry->length);
+        } else {
+            bitReaderSkip(reader, entry->firstLength);
+        }
+    }
+    return (size_t)(out - start);
+}
+
+size_t decodeWithTable(const DecodeTable *table, const unsigned char *compressed, uint64_t bitLength, char *decompressed, size_t capacity) {
+    BitReader reader;
+    bitReaderInit(&reader, compressed, bitLength);
+    size_t decoded = decodeFast(table, &reader, decompressed, capacity);
+    return decoded + decodeTail(table, &reader, decompressed + decoded, capacity - decoded);
+}
+
+// Refill and primary probe on one stream of decodeFour, on local copies of the BitReader fields
+#define FOUR_REFILL(buffer, bits, in) do { \
+        (buffer) |= loadBigEndian64(in) >> (bits); \
+        (in) += (63 - (bits)) >> 3; \
+        (bits) |= 56; \
+    } while (0)
+
+#define FOUR_PROBE(buffer, bits, out) do { \
+        const DecodeEntry *entry_ = &primary[(buffer) >> (64 - DECODE_TABLE_BITS)]; \
+        unsigned used_ = 0; \
+        if (entry_->count == 0) { \
+            entry_ = followLink(table, (buffer), entry_, &used_); \
+        } \
+        stalled |= entry_->count == 0; /* An unused bit pattern: leave it to the tail to report */ \
+        (out)[0] = (char)entry_->value; \
+        (out)[1] = (char)(entry_->value >> 16); \
+        (out) += entry_->count; \
+        used_ += entry_->length; \
+        (buffer) <<= used_; \
+        (bits) -= used_; \
+    } while (0)
+
+// Resolves a link entry from bits already in `buffer`; *used receives the bits of the tables passed through.
+// Returns the unused-pattern entry (count and length 0) if the code is invalid.
+static const DecodeEntry *followLink(const DecodeTable *table, uint64_t buffer, const DecodeEntry *entry, unsigned *used) {
+    static const DecodeEntry invalid = {0, 0, 0, 0};
+    unsigned width = DECODE_TABLE_BITS;
+    while (entry->count == 0) {
+        if (entry->length == 0) {
+            *used = 0;
+            return &invalid;
+        }
+        *used += width;
+        width = entry->length;
+        entry = &table->entries[entry->value + ((buffer << *used) >> (64 - width))];
+    }
+    return entry;
+}
+
+// Start of the input tail a stream must not enter in decodeFour: beyond it fewer than safeBits bits, or
+// less than a whole word, may remain
+static const unsigned char *fastLimit(const BitReader *reader, uint64_t safeBits) {
+    uint64_t margin = (safeBits + 7) / 8 + 8;
+    return reader->bitsLeft > 8 * margin ? reader->end - margin : reader->in;
+}
+
+// Copies a stream's local state back into its BitReader, settling bitsLeft for the bits used since `in`
+static void settleReader(BitReader *reader, uint64_t buffer, unsigned count, const unsigned char *in) {
+    reader->bitsLeft -= (uint64_t)(in - reader->in) * 8 + reader->bitCount - count;
+    reader->bitBuffer = buffer;
+    reader->bitCount = count;
+    reader->in = in;
+}
+
+// Interleaved fast loop over four streams. The streams' decode chains are independent, so probing each
+// stream in turn keeps four lookups in flight instead of waiting on one code's length before the next.
+// The reader state is held in plain locals so it stays in registers across the byte stores, and each
+// stream is bounded by input position so bitsLeft is settled only once at the end. Long codes are
+// resolved from the bits already buffered, so a refill round makes as many probes as the longest code
+// allows (at most four); tables whose codes are too long for two probes are left to the caller.
+static void decodeFour(const DecodeTable *table, BitReader *readers, char **outs, char *const *ends) {
+    const DecodeEntry *primary = table->entries;
+    unsigned longest = table->maxLength > DECODE_TABLE_BITS ? table->maxLength : DECODE_TABLE_BITS;
+    int probes = 56 / longest > 4 ? 4 : (int)(56 / longest);
+    uint64_t safeBits = (uint64_t)(probes + 1) * longest;
+    uint64_t buffer0 = readers[0].bitBuffer, buffer1 = readers[1].bitBuffer, buffer2 = readers[2].bitBuffer, buffer3 = readers[3].bitBuffer;
+    unsigned count0 = readers[0].bitCount, count1 = readers[1].bitCount, count2 = readers[2].bitCount, count3 = readers[3].bitCount;
+    const unsigned char *in0 = readers[0].in, *in1 = readers[1].in, *in2 = readers[2].in, *in3 = readers[3].in;
+    const unsigned char *limit0 = fastLimit(&readers[0], safeBits), *limit1 = fastLimit(&readers[1], safeBits);
+    const unsigned char *limit2 = fastLimit(&readers[2], safeBits), *limit3 = fastLimit(&readers[3], safeBits);
+    char *out0 = outs[0], *out1 = outs[1], *out2 = outs[2], *out3 = outs[3];
+    int stalled = 0;
+
+    while (!stalled && in0 < limit0 && in1 < limit1 && in2 < limit2 && in3 < limit3 &&
+           ends[0] - out0 >= 8 && ends[1] - out1 >= 8 && ends[2] - out2 >= 8 && ends[3] - out3 >= 8) {
+        FOUR_REFILL(buffer0, count0, in0);
+        FOUR_REFILL(buffer1, count1, in1);
+        FOUR_REFILL(buffer2, count2, in2);
+        FOUR_REFILL(buffer3, count3, in3);
+        for (int probe = 0; probe < probes; probe++) {
+            FOUR_PROBE(buffer0, count0, out0);
+            FOUR_PROBE(buffer1, count1, out1);
+            FOUR_PROBE(buffer2, count2, out2);
+            FOUR_PROBE(buffer3, count3, out3);
+        }
+    }
+    // A stalled stream hit an unused bit pattern; the tail finds and reports it
+
+    settleReader(&readers[0], buffer0, count0, in0);
+    settleReader(&readers[1], buffer1, count1, in1);
+    settleReader(&readers[2], buffer2, count2, in2);
+    settleReader(&readers[3], buffer3, count3, in3);
+    outs[0] = out0;
+    outs[1] = out1;
+    outs[2] = out2;
+    outs[3] = out3;
+}
+
+int decodeStreamsWithTable(const DecodeTable *table, const unsigned char *compressed, const uint64_t streamBits[], int streamCount,
+                           char *decompressed, size_t size) {
+    if (streamCount < 1 || streamCount > HUF_MAX_STREAMS) {
+        return -1;
+    }
+    BitReader readers[HUF_MAX_STREAMS];
+    char *outs[HUF_MAX_STREAMS];
+    char *ends[HUF_MAX_STREAMS];
+    size_t segment = HUF_STREAM_SEGMENT(size, streamCount);
+    for (int s = 0; s < streamCount; s++) {
+        size_t start = (size_t)s * segment < size ? (size_t)s * segment : size;
+        bitReaderInit(&readers[s], compressed, streamBits[s]);
+        compressed += (size_t)((streamBits[s] + 7) / 8);
+        outs[s] = decompressed + start;
+        ends[s] = decompressed + (size - start < segment ? size : start + segment);
+    }
+
+    // Streams run four at a time while at least two codes fit in a refill; the rest are decoded one at a time
+    if (table->maxLength <= 28) {
+        for (int s = 0; s + 4 <= streamCount; s += 4) {
+            decodeFour(table, readers + s, outs + s, ends + s);
+        }
+    }
+
+    int status = 0;
+    for (int s = 0; s < streamCount; s++) {
+        outs[s] += decodeFast(table, &readers[s], outs[s], (size_t)(ends[s] - outs[s]));
+        outs[s] += decodeTail(table, &readers[s], outs[s], (size_t)(ends[s] - outs[s]));
+        if (readers[s].bitsLeft != 0 || outs[s] != ends[s]) {
+            status = -1;
+        }
+    }
+    return status;
+}
+
+void freeDecodeTable(DecodeTable *table) {
+    free(table->entries);
+    table->entries = NULL;
+    table->size = 0;
+    table->capacity = 0;
+}
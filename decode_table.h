@@ -0,0 +1,118 @@
+#ifndef DECODE_TABLE_H
+#define DECODE_TABLE_H
+/*****************************************************************************
+**
+* Filename: decode_table.h
+*
+* Description:
+* Table-driven Huffman decoder. Instead of following one HuffmanNode pointer
+* per input bit, the decoder peeks DECODE_TABLE_BITS bits and resolves every
+* code that fits in them with a single probe of a flat table. When two short
+* codes fit in the same window the entry holds both symbols, so one probe can
+* emit two bytes. Codes longer than the primary window go through secondary
+* tables that are appended behind the primary one and reached by a link
+* entry.
+*
+* Dependencies:
+* compress_and_decompress.h
+*****************************************************************************/
+#include "compress_and_decompress.h"
+
+#define DECODE_TABLE_BITS 11
+
+/*****************************************************************************
+**
+* Structure: DecodeEntry
+*
+* Fields:
+* value (uint32_t) - Decoded symbols: the first in the low 16 bits, the second (if any) in the high 16 bits. For a link entry, the index of the subtable in `DecodeTable.entries`.
+* length (uint8_t) - Bits consumed by all symbols of the entry. For a link entry, the index width of the subtable.
+* firstLength (uint8_t) - Bits consumed by the first symbol alone.
+* count (uint8_t) - Symbols decoded by the entry (1 or 2). 0 marks a link entry, or an unused bit pattern when `length` is also 0.
+*****************************************************************************/
+typedef struct {
+    uint32_t value;
+    uint8_t length;
+    uint8_t firstLength;
+    uint8_t count;
+} DecodeEntry;
+
+/*****************************************************************************
+**
+* Structure: DecodeTable
+*
+* Fields:
+* entries (DecodeEntry*) - The primary table (1 << DECODE_TABLE_BITS entries) followed by every subtable.
+* size (size_t) - Entries in use.
+* capacity (size_t) - Entries allocated.
+* maxLength (unsigned) - Length of the longest code in the table.
+*****************************************************************************/
+typedef struct {
+    DecodeEntry *entries;
+    size_t size;
+    size_t capacity;
+    unsigned maxLength;
+} DecodeTable;
+
+/*****************************************************************************
+**
+* Function: buildDecodeTable
+*
+* Purpose:
+* Builds the lookup tables for the codes of the tree returned by
+* buildHuffmanTree(), using the same bit assignment as HuffmanCodes() (left
+* is 1, right is 0, and a lone leaf gets the code 0).
+*
+* Returns:
+* int - 0 on success, -1 if memory allocation fails or a code is longer than 64 bits.
+*****************************************************************************/
+int buildDecodeTable(DecodeTable *table, HuffmanNode *root);
+
+/*****************************************************************************
+**
+* Function: buildDecodeTableFromCodes
+*
+* Purpose:
+* Builds the lookup tables directly from integer codes, without a tree.
+* Symbols with a length of 0 are not in the code. The codes must be
+* prefix-free (canonicalCodes() checks this for canonical codes).
+*
+* Returns:
+* int - 0 on success, -1 if memory allocation fails.
+*****************************************************************************/
+int buildDecodeTableFromCodes(DecodeTable *table, const HuffmanCode codes[256]);
+
+/*****************************************************************************
+**
+* Function: decodeWithTable
+*
+* Purpose:
+* Decodes `bitLength` packed bits (as written by compress() or a BitWriter)
+* into `decompressed`, writing at most `capacity` bytes.
+*
+* Returns:
+* size_t - The number of bytes decoded. Decoding stops at the first invalid or truncated code, or when the output is full while bits remain.
+*****************************************************************************/
+size_t decodeWithTable(const DecodeTable *table, const unsigned char *compressed, uint64_t bitLength, char *decompressed, size_t capacity);
+
+/*****************************************************************************
+**
+* Function: decodeStreamsWithTable
+*
+* Purpose:
+* Decodes `streamCount` byte-aligned bit streams stored back to back at
+* `compressed` (stream i holds streamBits[i] bits) into the consecutive
+* segments of `decompressed` (see HUF_STREAM_SEGMENT). The streams are
+* decoded in one interleaved loop, so their lookups overlap instead of each
+* waiting on the previous code's length.
+*
+* Returns:
+* int - 0 if every stream decodes to exactly its segment, -1 otherwise.
+*****************************************************************************/
+int decodeStreamsWithTable(const DecodeTable *table, const unsigned char *compressed, const uint64_t streamBits[], int streamCount,
+                           char *decompressed, size_t size);
+
+// Releases the table memory.
+void freeDecodeTable(DecodeTable *table);
+
+#endif //DECODE_TABLE_H
@@ -0,0 +1,139 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "file_input.h"
+
+/*****************************************************************************
+**
+* Filename: file_input.c
+*
+* Description:
+* mmap and pread/read implementations of the whole-file input layer.
+*
+* Dependencies:
+* errno.h
+* fcntl.h
+* stdint.h
+* stdlib.h
+* string.h
+* sys/mman.h
+* sys/stat.h
+* unistd.h
+* file_input.h
+*****************************************************************************/
+
+// Bytes requested per pread()/read() call when the input cannot be mapped
+#define INPUT_READ_CHUNK ((size_t)1 << 20)
+
+static void resetInput(InputFile *input) {
+    input->data = (const unsigned char*)"";
+    input->size = 0;
+    input->mapping = NULL;
+    input->mappingSize = 0;
+    input->buffer = NULL;
+}
+
+// Maps a regular, non-empty file and points `data` at `offset`. Fails quietly so the caller can read instead.
+static int mapDescriptor(InputFile *input, int fd, off_t offset) {
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0 || offset < 0 || offset > info.st_size ||
+        (uint64_t)info.st_size > SIZE_MAX) {
+        return -1;
+    }
+    size_t length = (size_t)info.st_size;
+    void *mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return -1;
+    }
+    // The input is read once from front to back: read ahead aggressively and drop pages behind
+    madvise(mapping, length, MADV_SEQUENTIAL);
+    madvise(mapping, length, MADV_WILLNEED);
+
+    input->mapping = mapping;
+    input->mappingSize = length;
+    input->data = (const unsigned char*)mapping + offset;
+    input->size = length - (size_t)offset;
+    return 0;
+}
+
+// Reads from the current position to the end: pread() for seekable files, read() for pipes and terminals
+static HufError readDescriptor(InputFile *input, int fd) {
+    off_t offset = lseek(fd, 0, SEEK_CUR);
+    int seekable = offset >= 0;
+    if (seekable) {
+        posix_fadvise(fd, offset, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    unsigned char *buffer = NULL;
+    size_t capacity = 0;
+    size_t size = 0;
+    while (1) {
+        if (capacity - size < INPUT_READ_CHUNK) {
+            size_t grown = capacity * 2 > size + INPUT_READ_CHUNK ? capacity * 2 : size + INPUT_READ_CHUNK;
+            unsigned char *larger = realloc(buffer, grown);
+            if (larger == NULL) {
+                free(buffer);
+                return HUF_ERROR_ALLOCATION;
+            }
+            buffer = larger;
+            capacity = grown;
+        }
+        ssize_t got = seekable ? pread(fd, buffer + size, INPUT_READ_CHUNK, offset + (off_t)size)
+                               : read(fd, buffer + size, INPUT_READ_CHUNK);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0) {
+            free(buffer);
+            return HUF_ERROR_READ;
+        }
+        if (got == 0) {
+            break;
+        }
+        size += (size_t)got;
+    }
+    input->buffer = buffer;
+    input->data = buffer;
+    input->size = size;
+    return HUF_OK;
+}
+
+HufError openInputFile(InputFile *input, const char *filename) {
+    resetInput(input);
+    int isStdin = strcmp(filename, "-") == 0;
+    int fd = isStdin ? STDIN_FILENO : open(filename, O_RDONLY);
+    if (fd < 0) {
+        return HUF_ERROR_READ;
+    }
+    HufError status = HUF_OK;
+    if (mapDescriptor(input, fd, isStdin ? lseek(fd, 0, SEEK_CUR) : 0) != 0) {
+        status = readDescriptor(input, fd);
+    }
+    if (!isStdin) {
+        close(fd);
+    }
+    return status;
+}
+
+int mapInputStream(InputFile *input, FILE *file) {
+    resetInput(input);
+    off_t position = ftello(file);
+    if (position < 0 || mapDescriptor(input, fileno(file), position) != 0) {
+        return -1;
+    }
+    fseeko(file, 0, SEEK_END);
+    return 0;
+}
+
+void closeInputFile(InputFile *input) {
+    if (input->mapping != NULL) {
+        munmap(input->mapping, input->mappingSize);
+    }
+    free(input->buffer);
+    resetInput(input);
+}
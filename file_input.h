@@ -0,0 +1,75 @@
+#ifndef FILE_INPUT_H
+#define FILE_INPUT_H
+/*****************************************************************************
+**
+* Filename: file_input.h
+*
+* Description:
+* Whole-file input layer. A regular file is memory-mapped with sequential
+* and will-need hints, so counting and encoding read it straight from the
+* page cache in one buffer with no per-byte library calls. Files that
+* cannot be mapped are read with large pread() calls, and pipes with
+* read(), into one heap buffer. Either way the caller gets a single
+* contiguous view of the input that it can pass to the histogram and to
+* the encoder, instead of opening and reading the file once for each.
+*
+* Dependencies:
+* stdio.h
+* stddef.h
+* huf_error.h
+*****************************************************************************/
+#include <stdio.h>
+#include <stddef.h>
+#include "huf_error.h"
+
+/*****************************************************************************
+**
+* Structure: InputFile
+*
+* Fields:
+* data (const unsigned char*) - The input bytes.
+* size (size_t) - Number of bytes at `data`.
+* mapping (void*) - Start of the memory mapping, or NULL if the input was read into `buffer`.
+* mappingSize (size_t) - Length of the mapping.
+* buffer (unsigned char*) - Heap copy of the input when it is not mapped.
+*****************************************************************************/
+typedef struct {
+    const unsigned char *data;
+    size_t size;
+    void *mapping;
+    size_t mappingSize;
+    unsigned char *buffer;
+} InputFile;
+
+/*****************************************************************************
+**
+* Function: openInputFile
+*
+* Purpose:
+* Maps or reads the whole of `filename` ("-" for standard input). The
+* file descriptor is closed before returning; the data stays valid until
+* closeInputFile().
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_READ if the file cannot be opened or read, or HUF_ERROR_ALLOCATION.
+*****************************************************************************/
+HufError openInputFile(InputFile *input, const char *filename);
+
+/*****************************************************************************
+**
+* Function: mapInputStream
+*
+* Purpose:
+* Maps the rest of an open stream, from its current position to the end,
+* when it is a regular file, and moves the stream to the end. Streaming
+* encoders use this to feed whole blocks from the mapping without copying.
+*
+* Returns:
+* int - 0 on success; -1 if `file` is not a mappable regular file (for example a pipe), in which case the stream is untouched and the caller reads it as usual.
+*****************************************************************************/
+int mapInputStream(InputFile *input, FILE *file);
+
+// Unmaps or frees the input.
+void closeInputFile(InputFile *input);
+
+#endif //FILE_INPUT_H
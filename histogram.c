@@ -0,0 +1,122 @@
+#include <string.h>
+#include "histogram.h"
+
+#if !defined(HUF_NO_AVX2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HISTOGRAM_AVX2 1
+#include <immintrin.h>
+#endif
+
+/*****************************************************************************
+**
+* Filename: histogram.c
+*
+* Description:
+* Portable and AVX2 histogram kernels and the run-time choice between them.
+* Both count into 32-bit sub-histograms, so the input is taken in pieces
+* of at most HISTOGRAM_PIECE bytes and each piece's counts are folded into
+* the caller's 64-bit totals.
+*
+* Dependencies:
+* string.h
+* histogram.h
+* immintrin.h (x86 only)
+*****************************************************************************/
+
+#define HISTOGRAM_TABLES 8
+#define HISTOGRAM_PIECE ((size_t)1 << 30)
+#define REPEATED_BYTE 0x0101010101010101ull
+
+static inline uint64_t loadWord(const unsigned char *p) {
+    uint64_t word;
+    memcpy(&word, p, sizeof word);
+    return word;
+}
+
+// Counts the eight bytes of `word` into four sub-histograms starting at `table`
+#define COUNT_WORD_4(tables, table, word) do { \
+        tables[(table) + 0][(word) & 0xFF]++; \
+        tables[(table) + 1][((word) >> 8) & 0xFF]++; \
+        tables[(table) + 2][((word) >> 16) & 0xFF]++; \
+        tables[(table) + 3][((word) >> 24) & 0xFF]++; \
+        tables[(table) + 0][((word) >> 32) & 0xFF]++; \
+        tables[(table) + 1][((word) >> 40) & 0xFF]++; \
+        tables[(table) + 2][((word) >> 48) & 0xFF]++; \
+        tables[(table) + 3][(word) >> 56]++; \
+    } while (0)
+
+// Four interleaved sub-histograms, 16 bytes per step; a step of one repeated byte is a single add
+static void countPortable(const unsigned char *data, size_t size, uint32_t tables[HISTOGRAM_TABLES][256]) {
+    const unsigned char *end = data + size;
+    while (end - data >= 16) {
+        uint64_t first = loadWord(data);
+        uint64_t second = loadWord(data + 8);
+        if (first == second && first == (first & 0xFF) * REPEATED_BYTE) {
+            tables[0][first & 0xFF] += 16;
+        } else {
+            COUNT_WORD_4(tables, 0, first);
+            COUNT_WORD_4(tables, 0, second);
+        }
+        data += 16;
+    }
+    while (data < end) {
+        tables[0][*data++]++;
+    }
+}
+
+#ifdef HISTOGRAM_AVX2
+// Eight sub-histograms, 32 bytes per step; one vector compare finds steps of a single repeated byte
+__attribute__((target("avx2")))
+static void countAvx2(const unsigned char *data, size_t size, uint32_t tables[HISTOGRAM_TABLES][256]) {
+    const unsigned char *end = data + size;
+    while (end - data >= 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *)data);
+        __m256i repeated = _mm256_set1_epi8((char)data[0]);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, repeated)) == -1) {
+            tables[0][data[0]] += 32;
+        } else {
+            uint64_t word0 = loadWord(data);
+            uint64_t word1 = loadWord(data + 8);
+            uint64_t word2 = loadWord(data + 16);
+            uint64_t word3 = loadWord(data + 24);
+            COUNT_WORD_4(tables, 0, word0);
+            COUNT_WORD_4(tables, 4, word1);
+            COUNT_WORD_4(tables, 0, word2);
+            COUNT_WORD_4(tables, 4, word3);
+        }
+        data += 32;
+    }
+    // Leave the upper register halves clean, or every SSE instruction after this (libm's included) pays a transition
+    _mm256_zeroupper();
+    countPortable(data, (size_t)(end - data), tables);
+}
+#endif
+
+void countHistogram(const unsigned char *data, size_t size, uint64_t counts[256]) {
+    uint32_t tables[HISTOGRAM_TABLES][256];
+#ifdef HISTOGRAM_AVX2
+    int useAvx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    while (size > 0) {
+        size_t piece = size < HISTOGRAM_PIECE ? size : HISTOGRAM_PIECE;
+        memset(tables, 0, sizeof tables);
+#ifdef HISTOGRAM_AVX2
+        if (useAvx2) {
+            countAvx2(data, piece, tables);
+        } else {
+            countPortable(data, piece, tables);
+        }
+#else
+        countPortable(data, piece, tables);
+#endif
+        for (int value = 0; value < 256; value++) {
+            uint64_t total = 0;
+            for (int table = 0; table < HISTOGRAM_TABLES; table++) {
+                total += tables[table][value];
+            }
+            counts[value] += total;
+        }
+        data += piece;
+        size -= piece;
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+/*****************************************************************************
+**
+* Filename: histogram.h
+*
+* Description:
+* Byte histogram kernel used by countFrequencies() and the block encoder.
+* A single table of counters stalls whenever the same byte value repeats,
+* because each increment has to wait for the previous store to the same
+* counter. The kernel spreads consecutive bytes over interleaved
+* sub-histograms, which are merged at the end, and counts runs of one byte
+* value with a single add. On x86 CPUs with AVX2 (detected at run time)
+* it checks 32 bytes at a time for runs and uses eight sub-histograms.
+* Define HUF_NO_AVX2 to build only the portable path.
+*
+* Counts are 64-bit, so inputs of any size can be counted.
+*
+* Dependencies:
+* stddef.h
+* stdint.h
+*****************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+/*****************************************************************************
+**
+* Function: countHistogram
+*
+* Purpose:
+* Adds the number of occurrences of each byte value in `data` to
+* `counts`, so a large input can be counted in pieces. The caller zeroes
+* `counts` before the first piece.
+*
+* Parameters:
+* data (const unsigned char*) - The bytes to count.
+* size (size_t) - Number of bytes in `data`.
+* counts (uint64_t*) - 256 counters, indexed by byte value.
+*****************************************************************************/
+void countHistogram(const unsigned char *data, size_t size, uint64_t counts[256]);
+
+#endif //HISTOGRAM_H
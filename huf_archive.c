@@ -0,0 +1,181 @@
+#include <stdlib.h>
+#include <string.h>
+#include "huf_archive.h"
+#include "canonical.h"
+
+/*****************************************************************************
+**
+* Filename: huf_archive.c
+*
+* Description:
+* Block lookup by decoded offset, block reads through the index, and the
+* one-block cache for partial reads.
+*
+* Dependencies:
+* stdlib.h
+* string.h
+* huf_archive.h
+* canonical.h
+*****************************************************************************/
+
+static int reserve(unsigned char **buffer, size_t *capacity, size_t needed) {
+    if (needed <= *capacity) {
+        return 0;
+    }
+    unsigned char *grown = realloc(*buffer, needed);
+    if (grown == NULL) {
+        return -1;
+    }
+    *buffer = grown;
+    *capacity = needed;
+    return 0;
+}
+
+HufError hufArchiveOpen(HufArchive *archive, FILE *file) {
+    memset(archive, 0, sizeof *archive);
+    archive->file = file;
+    if (readBlockIndex(file, &archive->index) != 0) {
+        return HUF_ERROR_CORRUPT;
+    }
+    archive->blockCount = archive->index.count - 1;
+    archive->totalSize = archive->index.totalSize;
+    archive->cachedBlock = archive->blockCount;
+    archive->tableBlock = archive->blockCount;
+    archive->rawOffsets = malloc((archive->blockCount + 1) * sizeof(uint64_t));
+    if (archive->rawOffsets == NULL) {
+        hufArchiveClose(archive);
+        return HUF_ERROR_ALLOCATION;
+    }
+    archive->rawOffsets[0] = 0;
+    for (size_t block = 0; block < archive->blockCount; block++) {
+        archive->rawOffsets[block + 1] = archive->rawOffsets[block] + archive->index.rawSizes[block];
+    }
+    return HUF_OK;
+}
+
+// Loads the table a HUF_BLOCK_REPEAT block reuses: the code lengths of the nearest Huffman block before it, found by
+// reading just the start of each block on the way back
+static int loadRepeatedTable(HufArchive *archive, size_t block) {
+    unsigned char head[HUF_BLOCK_PREFIX_SIZE + 1 + CODE_LENGTH_HEADER_MAX];
+    while (block-- > 0) {
+        if (block == archive->tableBlock) {
+            return 0;
+        }
+        size_t encodedSize = (size_t)(archive->index.offsets[block + 1] - archive->index.offsets[block]);
+        size_t headSize = encodedSize < sizeof head ? encodedSize : sizeof head;
+        if (headSize < HUF_BLOCK_PREFIX_SIZE + 1 || fseek(archive->file, (long)archive->index.offsets[block], SEEK_SET) != 0 ||
+            fread(head, 1, headSize, archive->file) != headSize) {
+            return -1;
+        }
+        if (head[HUF_BLOCK_PREFIX_SIZE] != HUF_BLOCK_HUFFMAN) {
+            continue;
+        }
+        archive->tableBlock = archive->blockCount;
+        archive->table.valid = 0;
+        if (readCodeLengthHeader(head + HUF_BLOCK_PREFIX_SIZE + 1, headSize - HUF_BLOCK_PREFIX_SIZE - 1,
+                                 archive->table.lengths) < 0) {
+            return -1;
+        }
+        archive->table.valid = 1;
+        archive->tableBlock = block;
+        return 0;
+    }
+    return -1;
+}
+
+HufError hufArchiveReadBlock(HufArchive *archive, size_t block, unsigned char *dst, size_t capacity, size_t *decodedSize) {
+    if (block >= archive->blockCount) {
+        return HUF_ERROR_ARGUMENT;
+    }
+    if (capacity < archive->index.rawSizes[block]) {
+        return HUF_ERROR_DST_TOO_SMALL;
+    }
+    // readBlockIndex checked that the offsets increase, so the next entry bounds this block
+    size_t encodedSize = (size_t)(archive->index.offsets[block + 1] - archive->index.offsets[block]);
+    size_t rawSize;
+    size_t bodySize;
+    if (reserve(&archive->input, &archive->inputCapacity, encodedSize) != 0) {
+        return HUF_ERROR_ALLOCATION;
+    }
+    if (fseek(archive->file, (long)archive->index.offsets[block], SEEK_SET) != 0 ||
+        fread(archive->input, 1, encodedSize, archive->file) != encodedSize) {
+        return ferror(archive->file) ? HUF_ERROR_READ : HUF_ERROR_CORRUPT;
+    }
+    int type = encodedSize > HUF_BLOCK_PREFIX_SIZE ? archive->input[HUF_BLOCK_PREFIX_SIZE] : -1;
+    if (encodedSize < HUF_BLOCK_PREFIX_SIZE || readBlockPrefix(archive->input, &rawSize, &bodySize) != 0 ||
+        rawSize != archive->index.rawSizes[block] || HUF_BLOCK_PREFIX_SIZE + bodySize != encodedSize ||
+        (type == HUF_BLOCK_REPEAT && loadRepeatedTable(archive, block) != 0) ||
+        decodeBlock(archive->input, encodedSize, dst, capacity, decodedSize, &archive->table) != 0) {
+        return HUF_ERROR_CORRUPT;
+    }
+    if (type == HUF_BLOCK_HUFFMAN) {
+        archive->tableBlock = block; // decodeBlock left this block's table in archive->table
+    }
+    return HUF_OK;
+}
+
+// Returns the block holding decoded byte `offset` (which must be below totalSize)
+static size_t findBlock(const HufArchive *archive, uint64_t offset) {
+    size_t low = 0;
+    size_t high = archive->blockCount;
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+        if (archive->rawOffsets[middle] <= offset) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+HufError hufArchiveRead(HufArchive *archive, uint64_t offset, unsigned char *dst, size_t length) {
+    if (offset > archive->totalSize || length > archive->totalSize - offset) {
+        return HUF_ERROR_ARGUMENT;
+    }
+    if (length == 0) {
+        return HUF_OK;
+    }
+
+    size_t block = findBlock(archive, offset);
+    while (length > 0) {
+        size_t blockSize = archive->index.rawSizes[block];
+        size_t skip = (size_t)(offset - archive->rawOffsets[block]);
+        size_t take = blockSize - skip < length ? blockSize - skip : length;
+        size_t decodedSize;
+        if (skip == 0 && take == blockSize && block != archive->cachedBlock) {
+            HufError status = hufArchiveReadBlock(archive, block, dst, blockSize, &decodedSize);
+            if (status != HUF_OK) {
+                return status;
+            }
+        } else {
+            if (block != archive->cachedBlock) {
+                archive->cachedBlock = archive->blockCount;
+                if (reserve(&archive->output, &archive->outputCapacity, blockSize) != 0) {
+                    return HUF_ERROR_ALLOCATION;
+                }
+                HufError status = hufArchiveReadBlock(archive, block, archive->output, blockSize, &decodedSize);
+                if (status != HUF_OK) {
+                    return status;
+                }
+                archive->cachedBlock = block;
+            }
+            memcpy(dst, archive->output + skip, take);
+        }
+        dst += take;
+        offset += take;
+        length -= take;
+        block++;
+    }
+    return HUF_OK;
+}
+
+void hufArchiveClose(HufArchive *archive) {
+    freeBlockIndex(&archive->index);
+    free(archive->rawOffsets);
+    free(archive->input);
+    free(archive->output);
+    archive->rawOffsets = NULL;
+    archive->input = NULL;
+    archive->output = NULL;
+}
@@ -0,0 +1,103 @@
+#ifndef HUF_ARCHIVE_H
+#define HUF_ARCHIVE_H
+/*****************************************************************************
+**
+* Filename: huf_archive.h
+*
+* Description:
+* Random access to a compressed stream stored in a seekable file. The
+* block index at the end of the stream gives every block's position and
+* decoded size, so a byte range of the original input can be read by
+* decoding only the blocks that overlap it. Every block decoded is checked
+* against its CRC-32C. A block that reuses an earlier block's code table
+* (HUF_BLOCK_REPEAT) costs a short read of each block back to that one,
+* at most HUF_MAX_REPEAT_RUN of them in a stream from this encoder, unless
+* the table is the one loaded last.
+*
+* Usage:
+* hufArchiveOpen -> hufArchiveRead / hufArchiveReadBlock (any number of times, any order) -> hufArchiveClose
+*
+* Dependencies:
+* stdio.h
+* huf_stream.h
+*****************************************************************************/
+#include <stdio.h>
+#include "huf_stream.h"
+
+/*****************************************************************************
+**
+* Structure: HufArchive
+*
+* Fields:
+* file (FILE*) - The compressed stream; owned by the caller.
+* index (BlockIndex) - The stream's block index (the last entry is the end marker).
+* blockCount (size_t) - Data blocks in the stream.
+* totalSize (uint64_t) - Decoded size of the whole stream.
+* rawOffsets (uint64_t*) - Offset in the decoded data of each block's first byte, plus totalSize.
+* input (unsigned char*) - Buffer for one encoded block.
+* inputCapacity (size_t) - Bytes allocated for `input`.
+* output (unsigned char*) - The most recently decoded block, kept for reads that cover part of a block.
+* outputCapacity (size_t) - Bytes allocated for `output`.
+* cachedBlock (size_t) - Block held in `output`, or blockCount when there is none.
+* table (BlockTable) - The code lengths of the Huffman block `tableBlock`.
+* tableBlock (size_t) - Block whose table `table` holds, or blockCount when there is none.
+*****************************************************************************/
+typedef struct {
+    FILE *file;
+    BlockIndex index;
+    size_t blockCount;
+    uint64_t totalSize;
+    uint64_t *rawOffsets;
+    unsigned char *input;
+    size_t inputCapacity;
+    unsigned char *output;
+    size_t outputCapacity;
+    size_t cachedBlock;
+    BlockTable table;
+    size_t tableBlock;
+} HufArchive;
+
+/*****************************************************************************
+**
+* Function: hufArchiveOpen
+*
+* Purpose:
+* Checks the stream header of `file` and loads its block index.
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_CORRUPT if `file` is not seekable, is not a compressed stream or has no valid index, or HUF_ERROR_ALLOCATION.
+*****************************************************************************/
+HufError hufArchiveOpen(HufArchive *archive, FILE *file);
+
+/*****************************************************************************
+**
+* Function: hufArchiveReadBlock
+*
+* Purpose:
+* Decodes block `block` (0..blockCount-1) into `dst`, which must hold
+* index.rawSizes[block] bytes.
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_ARGUMENT if `block` is out of range, HUF_ERROR_DST_TOO_SMALL, HUF_ERROR_READ, HUF_ERROR_CORRUPT if the block is truncated or corrupt, or HUF_ERROR_ALLOCATION.
+*****************************************************************************/
+HufError hufArchiveReadBlock(HufArchive *archive, size_t block, unsigned char *dst, size_t capacity, size_t *decodedSize);
+
+/*****************************************************************************
+**
+* Function: hufArchiveRead
+*
+* Purpose:
+* Copies `length` bytes of the original input, starting at `offset`, to
+* `dst`. Blocks wholly inside the range are decoded straight into `dst`;
+* partly covered blocks go through the archive's one-block cache, so
+* sequential small reads decode each block once.
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_ARGUMENT if the range extends past totalSize, or an error of hufArchiveReadBlock.
+*****************************************************************************/
+HufError hufArchiveRead(HufArchive *archive, uint64_t offset, unsigned char *dst, size_t length);
+
+// Frees the archive's index and buffers. The file is left open.
+void hufArchiveClose(HufArchive *archive);
+
+#endif //HUF_ARCHIVE_H
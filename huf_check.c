@@ -0,0 +1,1132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "huf_check.h"
+#include "bit_io.h"
+#include "canonical.h"
+#include "context_model.h"
+#include "decode_table.h"
+#include "histogram.h"
+#include "huf_archive.h"
+#include "huf_context.h"
+#include "huf_dict.h"
+#include "huf_parallel.h"
+
+/*****************************************************************************
+**
+* Filename: huf_check.c
+*
+* Description:
+* Round-trip, untrusted-input, corpus and throughput checks over every
+* encoder and decoder (see huf_check.h), and the libFuzzer entry point.
+* The FILE-based coders are driven through fmemopen() and
+* open_memstream(), so nothing touches the disk. Check failures are
+* printed on standard output; the codec itself prints nothing.
+*
+* Dependencies:
+* stdio.h
+* stdlib.h
+* string.h
+* time.h
+* huf_check.h
+* canonical.h
+* context_model.h
+* decode_table.h
+* histogram.h
+* huf_archive.h
+* huf_context.h
+* huf_dict.h
+* huf_parallel.h
+*
+* Compilation:
+* clang -g -O1 -fsanitize=fuzzer,address,undefined -DHUF_FUZZ -pthread compress_and_decompress.c priority_queue.c histogram.c file_input.c bit_io.c decode_table.c canonical.c huffman_arena.c crc32c.c block_codec.c context_model.c huf_stream.c huf_archive.c huf_context.c huf_error.c huf_dict.c huf_stats.c thread_pool.c io_pipeline.c huf_parallel.c huf_check.c -o huf_fuzz -lm
+* ./huf_fuzz [corpus directory]
+*****************************************************************************/
+
+// The smallest blocks order-1 modelling applies to, so modest inputs still span several blocks of every type
+#define CHECK_BLOCK_SIZE HUF_ORDER1_MIN_BLOCK_SIZE
+#define CHECK_THREADS 3
+#define CHECK_MAX_SIZE ((size_t)256 << 10)
+#define CHECK_CORRUPTIONS 4
+#define CHECK_THROUGHPUT_SIZE ((size_t)4 << 20)
+
+// Decoders given untrusted input write at most this much; streams that claim more skip the FILE-based decoders
+#define CHECK_UNTRUSTED_OUTPUT ((size_t)1 << 20)
+
+static int fail(const char *mode, size_t size) {
+    printf("Check failed: %s, %zu bytes\n", mode, size);
+    return -1;
+}
+
+static int sameBytes(const void *a, size_t aSize, const void *b, size_t bSize) {
+    return aSize == bSize && (aSize == 0 || memcmp(a, b, aSize) == 0);
+}
+
+// xorshift32: the same seed gives the same inputs on every machine
+static uint32_t nextRandom(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static HuffmanNode *buildTree(const node_t nodes[], int count) {
+    MinHeap heap;
+    if (count == 0 || initHeap(&heap, count) != 0) {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        HuffmanNode *leaf = createLeafNode((char)nodes[i].index, nodes[i].weight);
+        if (leaf == NULL) {
+            while (heap.size > 0) {
+                freeHuffmanTree(heapPop(&heap));
+            }
+            freeHeap(&heap);
+            return NULL;
+        }
+        heapPush(&heap, leaf); // Cannot fail: the heap holds `count` nodes
+    }
+    HuffmanNode *root = buildHuffmanTreeHeap(&heap);
+    freeHeap(&heap);
+    return root;
+}
+
+typedef enum {
+    FILE_COMPRESS_REUSE,     // hufCompressStream() reusing tables
+    FILE_COMPRESS_PARALLEL,  // hufCompressParallel() on CHECK_THREADS threads
+    FILE_COMPRESS_PIPELINED, // hufCompressParallel() reusing tables, so coding on one thread
+    FILE_DECOMPRESS_SERIAL,  // hufDecompressStream()
+    FILE_DECOMPRESS_PARALLEL // hufDecompressParallel() on CHECK_THREADS threads
+} FileCodec;
+
+// Runs a FILE-based coder from memory to memory. *out receives a buffer to free, even when the coder fails.
+static int runFileCodec(FileCodec codec, int contextOrder, const unsigned char *in, size_t inSize, char **out,
+                        size_t *outSize) {
+    *out = NULL;
+    *outSize = 0;
+    FILE *input = fmemopen((void *)(inSize != 0 ? in : (const unsigned char *)""), inSize, "rb");
+    FILE *output = open_memstream(out, outSize);
+    HufError status = HUF_ERROR_ALLOCATION;
+    if (input != NULL && output != NULL) {
+        switch (codec) {
+            case FILE_COMPRESS_REUSE:
+                status = hufCompressStream(input, output, CHECK_BLOCK_SIZE, contextOrder, 1);
+                break;
+            case FILE_COMPRESS_PARALLEL:
+                status = hufCompressParallel(input, output, CHECK_BLOCK_SIZE, contextOrder, 0, CHECK_THREADS);
+                break;
+            case FILE_COMPRESS_PIPELINED:
+                status = hufCompressParallel(input, output, CHECK_BLOCK_SIZE, contextOrder, 1, CHECK_THREADS);
+                break;
+            case FILE_DECOMPRESS_SERIAL:
+                status = hufDecompressStream(input, output);
+                break;
+            case FILE_DECOMPRESS_PARALLEL:
+                status = hufDecompressParallel(input, output, CHECK_THREADS);
+                break;
+        }
+    }
+    if (input != NULL) {
+        fclose(input);
+    }
+    if (output != NULL) {
+        fclose(output); // Sets *out and *outSize
+    }
+    return status == HUF_OK ? 0 : -1;
+}
+
+// Reads the whole of `stream` (or all but its first and last thirds, `middle` set) through a HufArchive
+static int readArchive(const unsigned char *stream, size_t streamSize, int middle, unsigned char *dst, size_t capacity,
+                       size_t *decodedSize) {
+    *decodedSize = 0;
+    FILE *file = fmemopen((void *)stream, streamSize, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    HufArchive archive;
+    HufError status = hufArchiveOpen(&archive, file);
+    if (status == HUF_OK) {
+        uint64_t offset = middle ? archive.totalSize / 3 : 0;
+        uint64_t length = middle ? archive.totalSize - 2 * offset : archive.totalSize;
+        status = length <= capacity ? hufArchiveRead(&archive, offset, dst, (size_t)length) : HUF_ERROR_DST_TOO_SMALL;
+        *decodedSize = status == HUF_OK ? (size_t)length : 0;
+        hufArchiveClose(&archive);
+    }
+    fclose(file);
+    return status == HUF_OK ? 0 : -1;
+}
+
+// compress() with the table decoder and the reference tree walk
+static int checkTreeCoders(const unsigned char *data, size_t size) {
+    if (size == 0) {
+        return 0; // No symbols, no tree
+    }
+    node_t nodes[256];
+    int uniqueCount;
+    countBufferFrequencies(data, size, nodes, &uniqueCount);
+    HuffmanNode *root = buildTree(nodes, uniqueCount);
+    char (*codes)[MAX] = calloc(256, sizeof *codes);
+    if (root == NULL || codes == NULL) {
+        freeHuffmanTree(root);
+        free(codes);
+        return fail("allocation", size);
+    }
+    HuffmanCodes(root, codes);
+    size_t longest = 1;
+    for (int i = 0; i < 256; i++) {
+        size_t length = strlen(codes[i]);
+        longest = length > longest ? length : longest;
+    }
+    unsigned char *compressed = malloc(size * longest / 8 + 8);
+    char *decompressed = malloc(size);
+    int status = compressed != NULL && decompressed != NULL ? 0 : fail("allocation", size);
+    if (status == 0) {
+        uint64_t bits = compressBuffer(data, size, compressed, codes);
+        if (!sameBytes(data, size, decompressed, decompress(compressed, bits, decompressed, size, root))) {
+            status = fail("compress/decompress", size);
+        } else if (!sameBytes(data, size, decompressed, decompressTreeWalk(compressed, bits, decompressed, size, root))) {
+            status = fail("compress/tree walk", size);
+        }
+    }
+    free(compressed);
+    free(decompressed);
+    free(codes);
+    freeHuffmanTree(root);
+    return status;
+}
+
+// Length-limited canonical codes: single stream, every stream count, the counting encoder and the file format
+static int checkCanonicalCoders(const unsigned char *data, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    node_t nodes[256];
+    int uniqueCount;
+    uint8_t lengths[256];
+    HuffmanCode codes[256];
+    DecodeTable table;
+    countBufferFrequencies(data, size, nodes, &uniqueCount);
+    if (limitedCodeLengths(nodes, uniqueCount, HUF_BLOCK_MAX_CODE_LENGTH, lengths) != 0 ||
+        canonicalCodes(lengths, codes) != 0) {
+        return fail("canonical code lengths", size);
+    }
+    if (buildDecodeTableFromCodes(&table, codes) != 0) {
+        return fail("allocation", size);
+    }
+    size_t bound = CODE_LENGTH_HEADER_MAX + size * HUF_BLOCK_MAX_CODE_LENGTH / 8 + 8 * HUF_MAX_STREAMS + 8;
+    unsigned char *compressed = malloc(bound);
+    unsigned char *counted = malloc(bound);
+    char *decompressed = malloc(size);
+    int status = compressed != NULL && counted != NULL && decompressed != NULL ? 0 : fail("allocation", size);
+
+    if (status == 0) {
+        uint64_t bits = encodeWithCodes(codes, data, size, compressed);
+        if (!sameBytes(data, size, decompressed, decodeWithTable(&table, compressed, bits, decompressed, size))) {
+            status = fail("canonical single stream", size);
+        }
+    }
+    static const int streamCounts[] = {1, 3, HUF_MAX_STREAMS};
+    for (size_t i = 0; status == 0 && i < sizeof streamCounts / sizeof streamCounts[0]; i++) {
+        uint64_t streamBits[HUF_MAX_STREAMS];
+        uint64_t countedBits[HUF_MAX_STREAMS];
+        uint64_t counts[256];
+        uint64_t expected[256] = {0};
+        size_t bytes = encodeStreams(codes, data, size, streamCounts[i], compressed, streamBits);
+        size_t countedBytes = encodeStreamsCounting(codes, data, size, streamCounts[i], counted, countedBits, counts);
+        countHistogram(data, size, expected);
+        if (decodeStreamsWithTable(&table, compressed, streamBits, streamCounts[i], decompressed, size) != 0 ||
+            memcmp(decompressed, data, size) != 0) {
+            status = fail("canonical streams", size);
+        } else if (!sameBytes(compressed, bytes, counted, countedBytes) ||
+                   memcmp(streamBits, countedBits, (size_t)streamCounts[i] * sizeof streamBits[0]) != 0 ||
+                   memcmp(counts, expected, sizeof counts) != 0) {
+            status = fail("counting streams encoder", size);
+        }
+    }
+    if (status == 0) {
+        size_t headerBytes = writeCodeLengthHeader(lengths, compressed);
+        uint64_t bits = encodeWithCodes(codes, data, size, compressed + headerBytes);
+        size_t total = headerBytes + (size_t)((bits + 7) / 8);
+        if (!sameBytes(data, size, decompressed, decompressCanonical(compressed, total, bits, decompressed, size))) {
+            status = fail("canonical file format", size);
+        }
+    }
+    free(compressed);
+    free(counted);
+    free(decompressed);
+    freeDecodeTable(&table);
+    return status;
+}
+
+// encodeBlock chains reusing tables, decoded block by block; blockTableAdvance must follow the decoder's table
+static int checkBlocks(const unsigned char *data, size_t size, int contextOrder) {
+    size_t blockCount = (size + CHECK_BLOCK_SIZE - 1) / CHECK_BLOCK_SIZE;
+    if (blockCount == 0) {
+        return 0;
+    }
+    HuffmanArena arena;
+    unsigned char *encoded = malloc(blockCount * HUF_BLOCK_BOUND(CHECK_BLOCK_SIZE));
+    size_t *offsets = malloc((blockCount + 1) * sizeof *offsets);
+    unsigned char *decoded = malloc(CHECK_BLOCK_SIZE);
+    if (encoded == NULL || offsets == NULL || decoded == NULL || initArena(&arena, 256) != 0) {
+        free(encoded);
+        free(offsets);
+        free(decoded);
+        return fail("allocation", size);
+    }
+
+    int status = 0;
+    BlockTable *tables = calloc(3, sizeof *tables); // Encoder, decoder and advanced tables
+    offsets[0] = 0;
+    for (size_t block = 0; tables != NULL && block < blockCount; block++) {
+        size_t start = block * CHECK_BLOCK_SIZE;
+        size_t rawSize = size - start < CHECK_BLOCK_SIZE ? size - start : CHECK_BLOCK_SIZE;
+        size_t bytes = encodeBlock(&arena, data + start, rawSize, HUF_DEFAULT_STREAM_COUNT, contextOrder, &tables[0],
+                                   encoded + offsets[block]);
+        if (bytes == 0) {
+            status = fail("allocation", size);
+            break;
+        }
+        offsets[block + 1] = offsets[block] + bytes;
+    }
+    for (size_t block = 0; tables != NULL && status == 0 && block < blockCount; block++) {
+        size_t start = block * CHECK_BLOCK_SIZE;
+        size_t rawSize = size - start < CHECK_BLOCK_SIZE ? size - start : CHECK_BLOCK_SIZE;
+        size_t blockSize = offsets[block + 1] - offsets[block];
+        size_t decodedSize;
+        if (decodeBlock(encoded + offsets[block], blockSize, decoded, CHECK_BLOCK_SIZE, &decodedSize, &tables[1]) != 0 ||
+            !sameBytes(data + start, rawSize, decoded, decodedSize)) {
+            status = fail(contextOrder ? "order-1 blocks reusing tables" : "blocks reusing tables", size);
+        } else if (blockTableAdvance(encoded + offsets[block], blockSize, &tables[2]) != 0 ||
+                   tables[1].valid != tables[2].valid ||
+                   memcmp(tables[1].lengths, tables[2].lengths, sizeof tables[1].lengths) != 0) {
+            status = fail("blockTableAdvance", size);
+        }
+    }
+    if (tables == NULL) {
+        status = fail("allocation", size);
+    }
+    free(tables);
+    free(encoded);
+    free(offsets);
+    free(decoded);
+    freeArena(&arena);
+    return status;
+}
+
+// Every stream decoder on one encoder's output
+static int decodeStreamAllWays(const unsigned char *stream, size_t streamSize, const unsigned char *data, size_t size,
+                               const char *encoder) {
+    char mode[96];
+    unsigned char *decoded = malloc(size + 1);
+    if (decoded == NULL) {
+        return fail("allocation", size);
+    }
+    HufContext *context = hufContextCreate(0);
+    size_t decodedSize = 0;
+    int status = 0;
+    if (context == NULL ||
+        hufContextDecompress(context, stream, streamSize, decoded, size, &decodedSize) != HUF_OK ||
+        !sameBytes(data, size, decoded, decodedSize)) {
+        snprintf(mode, sizeof mode, "%s, one-shot decoder", encoder);
+        status = fail(mode, size);
+    }
+    hufContextDestroy(context);
+
+    // The last run spoils the index trailer, sending the parallel decoder down its front-to-back path for pipes
+    unsigned char *unindexed = malloc(streamSize);
+    if (unindexed == NULL) {
+        free(decoded);
+        return fail("allocation", size);
+    }
+    memcpy(unindexed, stream, streamSize);
+    unindexed[streamSize - 1] ^= 0xFF;
+    static const FileCodec decoders[] = {FILE_DECOMPRESS_SERIAL, FILE_DECOMPRESS_PARALLEL, FILE_DECOMPRESS_PARALLEL};
+    static const char *const decoderNames[] = {"stream decoder", "parallel decoder", "parallel decoder without index"};
+    for (int i = 0; status == 0 && i < 3; i++) {
+        char *output;
+        size_t outputSize;
+        if (runFileCodec(decoders[i], 0, i == 2 ? unindexed : stream, streamSize, &output, &outputSize) != 0 ||
+            !sameBytes(data, size, output, outputSize)) {
+            snprintf(mode, sizeof mode, "%s, %s", encoder, decoderNames[i]);
+            status = fail(mode, size);
+        }
+        free(output);
+    }
+    free(unindexed);
+    for (int middle = 0; status == 0 && middle < 2; middle++) {
+        size_t offset = middle ? size / 3 : 0;
+        if (readArchive(stream, streamSize, middle, decoded, size, &decodedSize) != 0 ||
+            !sameBytes(data + offset, middle ? size - 2 * offset : size, decoded, decodedSize)) {
+            snprintf(mode, sizeof mode, "%s, archive %s", encoder, middle ? "range" : "read");
+            status = fail(mode, size);
+        }
+    }
+    free(decoded);
+    return status;
+}
+
+// Walks a stream's blocks: no HUF_BLOCK_REPEAT block may be more than HUF_MAX_REPEAT_RUN blocks after the Huffman block
+// whose table it reuses. Returns 0, or -1 if one is or the blocks cannot be walked.
+static int checkRepeatRuns(const unsigned char *stream, size_t streamSize) {
+    size_t position = HUF_STREAM_HEADER_SIZE;
+    size_t sinceTable = 0;
+    for (;;) {
+        size_t rawSize;
+        size_t bodySize;
+        if (streamSize - position < HUF_BLOCK_PREFIX_SIZE || readBlockPrefix(stream + position, &rawSize, &bodySize) != 0 ||
+            bodySize > streamSize - position - HUF_BLOCK_PREFIX_SIZE) {
+            return -1;
+        }
+        if (rawSize == 0) {
+            return 0;
+        }
+        int type = stream[position + HUF_BLOCK_PREFIX_SIZE];
+        sinceTable++;
+        if (type == HUF_BLOCK_HUFFMAN) {
+            sinceTable = 0;
+        } else if (type == HUF_BLOCK_REPEAT && sinceTable > HUF_MAX_REPEAT_RUN) {
+            return -1;
+        }
+        position += HUF_BLOCK_PREFIX_SIZE + bodySize;
+    }
+}
+
+// The one-shot, parallel and table-reusing encoders; the parallel ones must match the one-shot and serial outputs exactly
+static int checkStreams(const unsigned char *data, size_t size, int contextOrder) {
+    size_t capacity = hufCompressBound(size, CHECK_BLOCK_SIZE);
+    unsigned char *stream = malloc(capacity);
+    HufContext *context = hufContextCreate(CHECK_BLOCK_SIZE);
+    size_t streamSize = 0;
+    int status = 0;
+    if (stream == NULL || context == NULL) {
+        status = fail("allocation", size);
+    } else if (hufContextSetContextOrder(context, contextOrder) != HUF_OK ||
+               hufContextCompress(context, data, size, stream, capacity, &streamSize) != HUF_OK) {
+        status = fail("one-shot encoder", size);
+    }
+    hufContextDestroy(context);
+    if (status == 0) {
+        status = decodeStreamAllWays(stream, streamSize, data, size, contextOrder ? "order-1 one-shot" : "one-shot");
+    }
+
+    char *output = NULL;
+    size_t outputSize;
+    if (status == 0 && (runFileCodec(FILE_COMPRESS_PARALLEL, contextOrder, data, size, &output, &outputSize) != 0 ||
+                        !sameBytes(stream, streamSize, output, outputSize))) {
+        status = fail("parallel encoder differs from one-shot", size);
+    }
+    free(output);
+    output = NULL;
+    if (status == 0 && runFileCodec(FILE_COMPRESS_REUSE, contextOrder, data, size, &output, &outputSize) != 0) {
+        status = fail("table-reusing encoder", size);
+    }
+    // Every block reuses a table only where that cannot come out larger, so the whole stream cannot either
+    if (status == 0 && outputSize > streamSize) {
+        status = fail("table-reusing encoder larger than without reuse", size);
+    }
+    if (status == 0 && checkRepeatRuns((unsigned char *)output, outputSize) != 0) {
+        status = fail("table reused too far from the block that wrote it", size);
+    }
+    if (status == 0) {
+        status = decodeStreamAllWays((unsigned char *)output, outputSize, data, size,
+                                     contextOrder ? "order-1 table-reusing" : "table-reusing");
+    }
+    char *pipelined = NULL;
+    size_t pipelinedSize;
+    if (status == 0 && (runFileCodec(FILE_COMPRESS_PIPELINED, contextOrder, data, size, &pipelined, &pipelinedSize) != 0 ||
+                        !sameBytes((unsigned char *)output, outputSize, pipelined, pipelinedSize))) {
+        status = fail("pipelined table-reusing encoder differs from serial", size);
+    }
+    free(pipelined);
+    free(output);
+    free(stream);
+    return status;
+}
+
+// Trains on the input itself, then round-trips it whole and through a saved and reloaded copy of the dictionary
+static int checkDictionary(const unsigned char *data, size_t size) {
+    HufDictionary dict;
+    HufDictionary loaded;
+    unsigned char saved[HUF_DICT_SAVED_MAX];
+    const unsigned char *samples[] = {data};
+    if (hufDictTrain(&dict, 1, samples, &size, 1) != 0) {
+        return fail("allocation", size);
+    }
+    size_t savedSize = hufDictSave(&dict, saved);
+    if (hufDictLoad(&loaded, saved, savedSize) != (long)savedSize) {
+        hufDictFree(&dict);
+        return fail("dictionary save/load", size);
+    }
+    unsigned char *record = malloc(HUF_DICT_RECORD_BOUND(size) + 8);
+    unsigned char *reloaded = malloc(HUF_DICT_RECORD_BOUND(size) + 8);
+    unsigned char *decoded = malloc(size + 1);
+    int status = record != NULL && reloaded != NULL && decoded != NULL ? 0 : fail("allocation", size);
+    if (status == 0) {
+        size_t recordSize = hufDictEncode(&dict, data, size, record);
+        long decodedSize = hufDictDecode(&dict, record, recordSize, decoded, size);
+        if (decodedSize < 0 || !sameBytes(data, size, decoded, (size_t)decodedSize)) {
+            status = fail("dictionary", size);
+        } else if (!sameBytes(record, recordSize, reloaded, hufDictEncode(&loaded, data, size, reloaded))) {
+            status = fail("reloaded dictionary", size);
+        }
+    }
+    free(record);
+    free(reloaded);
+    free(decoded);
+    hufDictFree(&dict);
+    hufDictFree(&loaded);
+    return status;
+}
+
+int hufCheckRoundTrip(const unsigned char *data, size_t size) {
+    if (checkTreeCoders(data, size) != 0 || checkCanonicalCoders(data, size) != 0 || checkDictionary(data, size) != 0) {
+        return -1;
+    }
+    for (int contextOrder = 0; contextOrder <= 1; contextOrder++) {
+        if (checkBlocks(data, size, contextOrder) != 0 || checkStreams(data, size, contextOrder) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// The arbitrary bits decoded with a tree built from their own byte counts: the table decoder must match the tree walk
+static int untrustedBits(const unsigned char *data, size_t size) {
+    node_t nodes[256];
+    int uniqueCount;
+    countBufferFrequencies(data, size, nodes, &uniqueCount);
+    if (uniqueCount < 2) {
+        return 0; // The tree walk reads any bit as a lone leaf's code; the table only reads 0
+    }
+    // A ragged bit length, and either an output that fills up before the bits run out or one that cannot
+    uint64_t bitLength = (uint64_t)size * 8 - (data[0] & 7);
+    size_t capacity = data[0] & 8 ? size / 2 : size * 8;
+    HuffmanNode *root = buildTree(nodes, uniqueCount);
+    char *table = malloc(capacity);
+    char *walk = malloc(capacity);
+    int status = root != NULL && table != NULL && walk != NULL ? 0 : fail("allocation", size);
+    if (status == 0) {
+        size_t tableSize = decompress(data, bitLength, table, capacity, root);
+        size_t walkSize = decompressTreeWalk(data, bitLength, walk, capacity, root);
+        if (!sameBytes(table, tableSize, walk, walkSize)) {
+            status = fail("table decoder differs from the tree walk", size);
+        }
+    }
+    free(table);
+    free(walk);
+    freeHuffmanTree(root);
+    return status;
+}
+
+// Block decoding with a table to repeat; a block that decodes must also be one blockTableAdvance accepts
+static int untrustedBlock(const unsigned char *data, size_t size) {
+    BlockTable *tables = calloc(2, sizeof *tables);
+    unsigned char *decoded = malloc(CHECK_UNTRUSTED_OUTPUT);
+    int status = tables != NULL && decoded != NULL ? 0 : fail("allocation", size);
+    if (status == 0) {
+        tables[0].valid = 1;
+        memset(tables[0].lengths, 8, sizeof tables[0].lengths);
+        tables[1] = tables[0];
+        size_t decodedSize;
+        if (decodeBlock(data, size, decoded, CHECK_UNTRUSTED_OUTPUT, &decodedSize, &tables[0]) == 0 &&
+            (decodedSize > CHECK_UNTRUSTED_OUTPUT || blockTableAdvance(data, size, &tables[1]) != 0 ||
+             memcmp(tables[0].lengths, tables[1].lengths, sizeof tables[0].lengths) != 0)) {
+            status = fail("decodeBlock accepts a block blockTableAdvance does not", size);
+        }
+    }
+    free(tables);
+    free(decoded);
+    return status;
+}
+
+// Bytes the blocks of a stream claim to hold, walking their prefixes up to the first implausible one
+static uint64_t claimedSize(const unsigned char *stream, size_t size) {
+    uint64_t total = 0;
+    size_t position = HUF_STREAM_HEADER_SIZE;
+    while (position <= size && size - position >= HUF_BLOCK_PREFIX_SIZE) {
+        size_t rawSize;
+        size_t bodySize;
+        if (readBlockPrefix(stream + position, &rawSize, &bodySize) != 0 || rawSize == 0) {
+            break;
+        }
+        total += rawSize;
+        position += HUF_BLOCK_PREFIX_SIZE + bodySize;
+    }
+    return total;
+}
+
+// Whichever stream decoders accept the bytes must produce the same output
+static int untrustedStream(const unsigned char *data, size_t size) {
+    unsigned char *decoded = malloc(CHECK_UNTRUSTED_OUTPUT);
+    unsigned char *archived = malloc(CHECK_UNTRUSTED_OUTPUT);
+    if (decoded == NULL || archived == NULL) {
+        free(decoded);
+        free(archived);
+        return fail("allocation", size);
+    }
+    const unsigned char *outputs[4];
+    size_t outputSizes[4];
+    int accepted[4] = {0};
+    char *streamed[2] = {NULL, NULL};
+
+    HufContext *context = hufContextCreate(0);
+    accepted[0] = context != NULL && hufContextDecompress(context, data, size, decoded, CHECK_UNTRUSTED_OUTPUT,
+                                                          &outputSizes[0]) == HUF_OK;
+    outputs[0] = decoded;
+    hufContextDestroy(context);
+    accepted[1] = size != 0 && readArchive(data, size, 0, archived, CHECK_UNTRUSTED_OUTPUT, &outputSizes[1]) == 0;
+    outputs[1] = archived;
+    // The serial decoder streams out every block before it reaches the index, so huge claims are not decoded
+    if (size != 0 && claimedSize(data, size) <= CHECK_UNTRUSTED_OUTPUT) {
+        accepted[2] = runFileCodec(FILE_DECOMPRESS_SERIAL, 0, data, size, &streamed[0], &outputSizes[2]) == 0;
+        accepted[3] = runFileCodec(FILE_DECOMPRESS_PARALLEL, 0, data, size, &streamed[1], &outputSizes[3]) == 0;
+    }
+    outputs[2] = (unsigned char *)streamed[0];
+    outputs[3] = (unsigned char *)streamed[1];
+
+    int status = 0;
+    for (int i = 1; i < 4; i++) {
+        for (int j = 0; status == 0 && j < i; j++) {
+            if (accepted[i] && accepted[j] && !sameBytes(outputs[i], outputSizes[i], outputs[j], outputSizes[j])) {
+                status = fail("stream decoders accept the same bytes with different output", size);
+            }
+        }
+    }
+    free(decoded);
+    free(archived);
+    free(streamed[0]);
+    free(streamed[1]);
+    return status;
+}
+
+// A record the dictionary decodes must re-encode to exactly the same bytes; saved dictionaries must parse safely
+static int untrustedDictionary(const unsigned char *data, size_t size) {
+    static const char sample[] = "the quick brown fox jumps over the lazy dog, eeeeeeee ttttt aaaa oooo\n";
+    const unsigned char *samples[] = {(const unsigned char *)sample};
+    size_t sampleSize = sizeof sample - 1;
+    HufDictionary dict;
+    if (hufDictTrain(&dict, 1, samples, &sampleSize, 1) != 0) {
+        return fail("allocation", size);
+    }
+    size_t capacity = size * 8;
+    unsigned char *decoded = malloc(capacity + 1);
+    unsigned char *record = malloc(HUF_DICT_RECORD_BOUND(capacity) + 8);
+    int status = decoded != NULL && record != NULL ? 0 : fail("allocation", size);
+    long decodedSize = status == 0 ? hufDictDecode(&dict, data, size, decoded, capacity) : -1;
+    if (decodedSize >= 0 && !sameBytes(data, size, record, hufDictEncode(&dict, decoded, (size_t)decodedSize, record))) {
+        status = fail("dictionary record does not re-encode to itself", size);
+    }
+    free(decoded);
+    free(record);
+    hufDictFree(&dict);
+
+    HufDictionary loaded;
+    if (hufDictLoad(&loaded, data, size) > 0) {
+        hufDictFree(&loaded);
+    }
+    return status;
+}
+
+// The code-length and order-1 header parsers, and a canonical payload after a header that parses
+static int untrustedHeaders(const unsigned char *data, size_t size) {
+    uint8_t lengths[256];
+    long headerBytes = readCodeLengthHeader(data, size, lengths);
+    if (headerBytes >= 0) {
+        size_t capacity = (size - (size_t)headerBytes) * 8;
+        char *decoded = malloc(capacity + 1);
+        if (decoded == NULL) {
+            return fail("allocation", size);
+        }
+        decompressCanonical(data, size, (uint64_t)(size - (size_t)headerBytes) * 8, decoded, capacity);
+        free(decoded);
+    }
+    Order1Model *model = malloc(sizeof *model);
+    if (model == NULL) {
+        return fail("allocation", size);
+    }
+    readOrder1Header(data, size, model);
+    free(model);
+    return 0;
+}
+
+int hufCheckUntrusted(const unsigned char *data, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    return untrustedBits(data, size) != 0 || untrustedBlock(data, size) != 0 || untrustedStream(data, size) != 0 ||
+                   untrustedDictionary(data, size) != 0 || untrustedHeaders(data, size) != 0
+               ? -1
+               : 0;
+}
+
+int hufFuzzOne(const unsigned char *data, size_t size) {
+    return hufCheckRoundTrip(data, size) == 0 && hufCheckUntrusted(data, size) == 0 ? 0 : -1;
+}
+
+#ifdef HUF_FUZZ
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (hufFuzzOne(data, size) != 0) {
+        abort(); // Reported as a crash, with the input saved
+    }
+    return 0;
+}
+#endif
+
+static size_t fillEmpty(unsigned char *data, size_t size, uint32_t *state) {
+    (void)data;
+    (void)size;
+    (void)state;
+    return 0;
+}
+
+static size_t fillOneByte(unsigned char *data, size_t size, uint32_t *state) {
+    (void)size;
+    data[0] = (unsigned char)nextRandom(state);
+    return 1;
+}
+
+static size_t fillOneValue(unsigned char *data, size_t size, uint32_t *state) {
+    memset(data, (unsigned char)nextRandom(state), size);
+    return size;
+}
+
+static size_t fillTwoValues(unsigned char *data, size_t size, uint32_t *state) {
+    unsigned char values[2] = {(unsigned char)nextRandom(state), (unsigned char)nextRandom(state)};
+    for (size_t i = 0; i < size; i++) {
+        data[i] = values[nextRandom(state) % 5 == 0];
+    }
+    return size;
+}
+
+// Byte b occurs fib(b) times, which gives the deepest possible tree for the size
+static size_t fillFibonacci(unsigned char *data, size_t size, uint32_t *state) {
+    uint64_t previous = 0;
+    uint64_t count = 1;
+    size_t filled = 0;
+    unsigned first = nextRandom(state) % 256;
+    for (unsigned symbol = 0; symbol < 256 && count <= size - filled; symbol++) {
+        memset(data + filled, (int)((first + symbol) % 256), (size_t)count);
+        filled += (size_t)count;
+        uint64_t next = previous + count;
+        previous = count;
+        count = next;
+    }
+    return filled;
+}
+
+static size_t fillAllValues(unsigned char *data, size_t size, uint32_t *state) {
+    (void)size;
+    for (int i = 0; i < 256; i++) {
+        data[i] = (unsigned char)i;
+    }
+    for (int i = 255; i > 0; i--) {
+        int j = (int)(nextRandom(state) % (uint32_t)(i + 1));
+        unsigned char swap = data[i];
+        data[i] = data[j];
+        data[j] = swap;
+    }
+    return 256;
+}
+
+static size_t fillUniform(unsigned char *data, size_t size, uint32_t *state) {
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (unsigned char)(nextRandom(state) >> 24);
+    }
+    return size;
+}
+
+// Small values far more often than large ones
+static size_t fillSkewed(unsigned char *data, size_t size, uint32_t *state) {
+    for (size_t i = 0; i < size; i++) {
+        uint32_t r = nextRandom(state);
+        data[i] = (unsigned char)((r >> 8) % (1 + (r & 0xFF)));
+    }
+    return size;
+}
+
+// Log-like lines, which order-1 modelling and table reuse both pay off on
+static size_t fillText(unsigned char *data, size_t size, uint32_t *state) {
+    static const char *const words[] = {"INFO ", "WARN ", "ERROR ", "request ", "handled ", "in ", "ms ", "user=",
+                                        "id=",   "GET ",  "POST ",  "/index ",  "200 ",     "404 ", "the ", "\n"};
+    size_t filled = 0;
+    while (filled < size) {
+        uint32_t r = nextRandom(state);
+        char word[16];
+        int length = r % 4 == 0 ? snprintf(word, sizeof word, "%u ", (r >> 8) % 10000)
+                                : snprintf(word, sizeof word, "%s", words[(r >> 2) % 16]);
+        size_t copy = (size_t)length < size - filled ? (size_t)length : size - filled;
+        memcpy(data + filled, word, copy);
+        filled += copy;
+    }
+    return size;
+}
+
+static size_t fillRuns(unsigned char *data, size_t size, uint32_t *state) {
+    size_t filled = 0;
+    while (filled < size) {
+        uint32_t r = nextRandom(state);
+        size_t run = 1 + (r >> 8) % 300;
+        run = run < size - filled ? run : size - filled;
+        memset(data + filled, (unsigned char)r, run);
+        filled += run;
+    }
+    return size;
+}
+
+// Text that turns to noise halfway, so table reuse misses and blocks are stored
+static size_t fillDrift(unsigned char *data, size_t size, uint32_t *state) {
+    fillText(data, size / 2, state);
+    fillUniform(data + size / 2, size - size / 2, state);
+    return size;
+}
+
+// A text block, more single-value blocks than a table may be reused across, then text again (ignores `size`)
+static size_t fillGap(unsigned char *data, size_t size, uint32_t *state) {
+    (void)size;
+    size_t gap = (HUF_MAX_REPEAT_RUN + 2) * CHECK_BLOCK_SIZE;
+    fillText(data, CHECK_BLOCK_SIZE, state);
+    memset(data + CHECK_BLOCK_SIZE, ' ', gap);
+    fillText(data + CHECK_BLOCK_SIZE + gap, 2 * CHECK_BLOCK_SIZE, state);
+    return 3 * CHECK_BLOCK_SIZE + gap;
+}
+
+/*****************************************************************************
+**
+* Structure: CheckGenerator
+*
+* Fields:
+* name (const char*) - Generator name in failure reports.
+* fill (size_t (*)(unsigned char*, size_t, uint32_t*)) - Writes up to `size` bytes from the random state (the fixed-size shapes ignore `size` and write at most CHECK_MAX_SIZE); returns the bytes written.
+*****************************************************************************/
+typedef struct {
+    const char *name;
+    size_t (*fill)(unsigned char *data, size_t size, uint32_t *state);
+} CheckGenerator;
+
+static const CheckGenerator generators[] = {
+    {"empty", fillEmpty},         {"one byte", fillOneByte}, {"one value", fillOneValue}, {"two values", fillTwoValues},
+    {"fibonacci", fillFibonacci}, {"all values", fillAllValues}, {"uniform", fillUniform}, {"skewed", fillSkewed},
+    {"text", fillText},           {"runs", fillRuns},        {"drift", fillDrift},         {"gap", fillGap},
+};
+
+// Mostly sizes either side of a segment or block boundary, otherwise short or long random ones
+static size_t pickSize(uint32_t *state) {
+    uint32_t r = nextRandom(state);
+    switch (r % 3) {
+        case 0: {
+            size_t unit = (r >> 2) & 1 ? CHECK_BLOCK_SIZE : HUF_MIN_SEGMENT_SIZE;
+            return (1 + (r >> 3) % 8) * unit + (r >> 6) % 3 - 1;
+        }
+        case 1:
+            return (r >> 2) % 4096;
+        default:
+            return (r >> 2) % CHECK_MAX_SIZE;
+    }
+}
+
+// Grows one block's decoded size in the index, and the total with it, so the index still agrees with itself but
+// no longer with the block. Returns 0, or -1 if the stream has no blocks.
+static int tamperIndex(unsigned char *stream, size_t streamSize, uint32_t *state) {
+    unsigned char *trailer = stream + streamSize - HUF_INDEX_TRAILER_SIZE;
+    size_t count = loadLittleEndian32(trailer + 8);
+    if (count < 2) {
+        return -1;
+    }
+    unsigned char *entry = trailer - count * HUF_INDEX_ENTRY_SIZE + (nextRandom(state) % (count - 1)) * HUF_INDEX_ENTRY_SIZE;
+    uint32_t grow = 1 + nextRandom(state) % 256;
+    storeLittleEndian32(entry + 8, loadLittleEndian32(entry + 8) + grow);
+    storeLittleEndian64(trailer, loadLittleEndian64(trailer) + grow);
+    return 0;
+}
+
+// Flips a few bits of the stream, truncates it or tampers with its index, then decodes it: failing is fine, wrong
+// output is not
+static int checkCorruption(const unsigned char *stream, size_t streamSize, const unsigned char *data, size_t size,
+                           uint32_t *state) {
+    unsigned char *corrupt = malloc(streamSize);
+    unsigned char *decoded = malloc(size + 1);
+    if (corrupt == NULL || decoded == NULL) {
+        free(corrupt);
+        free(decoded);
+        return fail("allocation", size);
+    }
+    memcpy(corrupt, stream, streamSize);
+    size_t corruptSize = streamSize;
+    uint32_t kind = nextRandom(state) % 4;
+    if (kind == 0) {
+        corruptSize = nextRandom(state) % streamSize;
+    } else if (kind != 1 || tamperIndex(corrupt, streamSize, state) != 0) {
+        for (uint32_t flips = 1 + nextRandom(state) % 3; flips > 0; flips--) {
+            corrupt[nextRandom(state) % streamSize] ^= (unsigned char)(1u << nextRandom(state) % 8);
+        }
+    }
+
+    HufContext *context = hufContextCreate(0);
+    size_t decodedSize = 0;
+    int accepted = context != NULL &&
+                   hufContextDecompress(context, corrupt, corruptSize, decoded, size, &decodedSize) == HUF_OK;
+    hufContextDestroy(context);
+    int untrusted = hufCheckUntrusted(corrupt, corruptSize);
+
+    int status = untrusted;
+    if (accepted && !sameBytes(data, size, decoded, decodedSize)) {
+        status = fail("corrupted stream decodes to the wrong output", size);
+    }
+    free(corrupt);
+    free(decoded);
+    return status;
+}
+
+int hufCheckCorpus(int rounds, uint32_t seed) {
+    unsigned char *data = malloc(CHECK_MAX_SIZE + 256);
+    unsigned char *stream = malloc(hufCompressBound(CHECK_MAX_SIZE + 256, CHECK_BLOCK_SIZE));
+    HufContext *context = hufContextCreate(CHECK_BLOCK_SIZE);
+    if (data == NULL || stream == NULL || context == NULL) {
+        free(data);
+        free(stream);
+        hufContextDestroy(context);
+        return fail("allocation", 0);
+    }
+    uint32_t state = seed != 0 ? seed : 1;
+    int failures = 0;
+    int corrupted = 0;
+    size_t generatorCount = sizeof generators / sizeof generators[0];
+    for (int round = 0; round < rounds; round++) {
+        const CheckGenerator *generator = &generators[(size_t)round % generatorCount];
+        size_t size = generator->fill(data, pickSize(&state), &state);
+        int status = hufCheckRoundTrip(data, size);
+
+        // Corrupt order-0 and order-1 streams in turn
+        size_t streamSize = 0;
+        if (status == 0 && size != 0 && hufContextSetContextOrder(context, round & 1) == HUF_OK &&
+            hufContextCompress(context, data, size, stream, hufCompressBound(size, CHECK_BLOCK_SIZE), &streamSize) == HUF_OK) {
+            for (int i = 0; status == 0 && i < CHECK_CORRUPTIONS; i++, corrupted++) {
+                status = checkCorruption(stream, streamSize, data, size, &state);
+            }
+        }
+        if (status != 0) {
+            printf("  in round %d: %s input, %zu bytes\n", round, generator->name, size);
+            failures++;
+        }
+    }
+    printf("%d inputs, %d corrupted streams: %d failure%s\n", rounds, corrupted, failures, failures == 1 ? "" : "s");
+    free(data);
+    free(stream);
+    hufContextDestroy(context);
+    return failures == 0 ? 0 : -1;
+}
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*****************************************************************************
+**
+* Structure: ThroughputCase
+*
+* Fields:
+* data, size - The input being timed.
+* root (HuffmanNode*) - Tree for compress() and the tree decoders.
+* codes (char (*)[MAX]) - HuffmanCodes() output for `root`.
+* bits (uint64_t) - Bits written by compress().
+* context (HufContext*) - One-shot coder for the block modes.
+* compressed (unsigned char*) - Output of the last encoder mode.
+* compressedSize (size_t) - Bytes in `compressed` (block modes).
+* capacity (size_t) - Bytes allocated for `compressed`.
+* decoded (unsigned char*) - Output of the last decoder mode.
+* decodedSize (size_t) - Bytes the last decoder produced, or 0 if it failed.
+*****************************************************************************/
+typedef struct {
+    const unsigned char *data;
+    size_t size;
+    HuffmanNode *root;
+    char (*codes)[MAX];
+    uint64_t bits;
+    HufContext *context;
+    unsigned char *compressed;
+    size_t compressedSize;
+    size_t capacity;
+    unsigned char *decoded;
+    size_t decodedSize;
+} ThroughputCase;
+
+static void timeCompress(ThroughputCase *test) {
+    test->bits = compressBuffer(test->data, test->size, test->compressed, test->codes);
+}
+
+static void timeDecompress(ThroughputCase *test) {
+    test->decodedSize = decompress(test->compressed, test->bits, (char *)test->decoded, test->size, test->root);
+}
+
+static void timeTreeWalk(ThroughputCase *test) {
+    test->decodedSize = decompressTreeWalk(test->compressed, test->bits, (char *)test->decoded, test->size, test->root);
+}
+
+static void timeBlockEncode(ThroughputCase *test) {
+    if (hufContextCompress(test->context, test->data, test->size, test->compressed, test->capacity,
+                           &test->compressedSize) != HUF_OK) {
+        test->compressedSize = 0;
+    }
+}
+
+static void timeBlockDecode(ThroughputCase *test) {
+    if (hufContextDecompress(test->context, test->compressed, test->compressedSize, test->decoded, test->size,
+                             &test->decodedSize) != HUF_OK) {
+        test->decodedSize = 0;
+    }
+}
+
+/*****************************************************************************
+**
+* Structure: ThroughputMode
+*
+* Fields:
+* name (const char*) - Mode name in the report and the baseline file.
+* run (void (*)(ThroughputCase*)) - Runs the mode once.
+* contextOrder (int) - Context order of the block modes.
+* decodes (int) - Set for decoders: their output is checked against the input after timing.
+*****************************************************************************/
+typedef struct {
+    const char *name;
+    void (*run)(ThroughputCase *test);
+    int contextOrder;
+    int decodes;
+} ThroughputMode;
+
+// Each decoder follows the encoder whose output it reads
+static const ThroughputMode throughputModes[] = {
+    {"compress", timeCompress, 0, 0},
+    {"decompress", timeDecompress, 0, 1},
+    {"tree-walk", timeTreeWalk, 0, 1},
+    {"block-encode", timeBlockEncode, 0, 0},
+    {"block-decode", timeBlockDecode, 0, 1},
+    {"order1-encode", timeBlockEncode, 1, 0},
+    {"order1-decode", timeBlockDecode, 1, 1},
+};
+
+#define THROUGHPUT_MODE_COUNT (sizeof throughputModes / sizeof throughputModes[0])
+
+// Reads the baseline MB/s of every mode (0 for modes the file does not list). Returns 0, or -1 if it cannot be read.
+static int readBaseline(const char *filename, double baseline[]) {
+    FILE *file = fopen(filename, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Unable to open baseline '%s'\n", filename);
+        return -1;
+    }
+    char line[256];
+    while (fgets(line, sizeof line, file) != NULL) {
+        char name[64];
+        double value;
+        if (line[0] == '#' || sscanf(line, "%63s %lf", name, &value) != 2) {
+            continue;
+        }
+        for (size_t i = 0; i < THROUGHPUT_MODE_COUNT; i++) {
+            if (strcmp(name, throughputModes[i].name) == 0) {
+                baseline[i] = value;
+            }
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+static int writeBaseline(const char *filename, const double results[], size_t size) {
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Unable to write baseline '%s'\n", filename);
+        return -1;
+    }
+    fprintf(file, "# huf check baseline, %zu byte input\n", size);
+    for (size_t i = 0; i < THROUGHPUT_MODE_COUNT; i++) {
+        fprintf(file, "%s %.1f\n", throughputModes[i].name, results[i]);
+    }
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+// Times every mode, fastest of `repetitions`; results[] receives MB/s. Returns 0, or -1 if a decoder's output is wrong.
+static int timeModes(ThroughputCase *test, int repetitions, double results[]) {
+    int status = 0;
+    for (size_t i = 0; i < THROUGHPUT_MODE_COUNT; i++) {
+        const ThroughputMode *mode = &throughputModes[i];
+        hufContextSetContextOrder(test->context, mode->contextOrder);
+        double best = 0;
+        for (int rep = 0; rep < repetitions; rep++) {
+            test->decodedSize = 0;
+            double start = nowSeconds();
+            mode->run(test);
+            double elapsed = nowSeconds() - start;
+            best = rep == 0 || elapsed < best ? elapsed : best;
+        }
+        results[i] = best > 0 ? (double)test->size / best / 1e6 : 0;
+        if (mode->decodes && !sameBytes(test->data, test->size, test->decoded, test->decodedSize)) {
+            status = fail(mode->name, test->size);
+        }
+    }
+    return status;
+}
+
+int hufCheckThroughput(const unsigned char *data, size_t size, int repetitions, const char *baseline, int record) {
+    unsigned char *generated = NULL;
+    if (data == NULL) {
+        uint32_t state = 12345;
+        generated = malloc(CHECK_THROUGHPUT_SIZE);
+        if (generated == NULL) {
+            return fail("allocation", CHECK_THROUGHPUT_SIZE);
+        }
+        size = fillText(generated, CHECK_THROUGHPUT_SIZE, &state);
+        data = generated;
+    }
+    double baselines[THROUGHPUT_MODE_COUNT] = {0};
+    if (baseline != NULL && !record && readBaseline(baseline, baselines) != 0) {
+        free(generated);
+        return -1;
+    }
+
+    node_t nodes[256];
+    int uniqueCount;
+    countBufferFrequencies(data, size, nodes, &uniqueCount);
+    ThroughputCase test = {data, size, buildTree(nodes, uniqueCount), calloc(256, sizeof *test.codes), 0,
+                           hufContextCreate(0), NULL, 0, hufCompressBound(size, 0), malloc(size + 1), 0};
+    int status = 0;
+    if (test.root != NULL && test.codes != NULL) {
+        HuffmanCodes(test.root, test.codes);
+        size_t longest = 1;
+        for (int i = 0; i < 256; i++) {
+            size_t length = strlen(test.codes[i]);
+            longest = length > longest ? length : longest;
+        }
+        test.capacity = size * longest / 8 + 8 > test.capacity ? size * longest / 8 + 8 : test.capacity;
+        test.compressed = malloc(test.capacity);
+    }
+    double results[THROUGHPUT_MODE_COUNT];
+    if (test.compressed == NULL || test.context == NULL || test.decoded == NULL) {
+        status = fail("allocation", size);
+    } else {
+        status = timeModes(&test, repetitions, results);
+        printf("throughput, %zu bytes, best of %d runs:\n", size, repetitions);
+        for (size_t i = 0; i < THROUGHPUT_MODE_COUNT; i++) {
+            printf("  %-16s %10.1f MB/s", throughputModes[i].name, results[i]);
+            if (baselines[i] > 0) {
+                int slow = results[i] < baselines[i] * HUF_CHECK_TOLERANCE;
+                printf("   baseline %8.1f (%+.0f%%)%s", baselines[i], (results[i] / baselines[i] - 1) * 100,
+                       slow ? " SLOW" : "");
+                status = slow ? -1 : status;
+            }
+            printf("\n");
+        }
+        if (baseline != NULL && record && writeBaseline(baseline, results, size) != 0) {
+            status = -1;
+        }
+    }
+    freeHuffmanTree(test.root);
+    free(test.codes);
+    hufContextDestroy(test.context);
+    free(test.compressed);
+    free(test.decoded);
+    free(generated);
+    return status;
+}
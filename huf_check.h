@@ -0,0 +1,112 @@
+#ifndef HUF_CHECK_H
+#define HUF_CHECK_H
+/*****************************************************************************
+**
+* Filename: huf_check.h
+*
+* Description:
+* Self-checks for the codec's many encoders and decoders. A round trip
+* runs one input through every encoder and decoder pair and requires each
+* to give back the input exactly: compress() with both decompress() and the
+* reference tree walk, the canonical single and multi-stream coders,
+* order-0, order-1 and table-reusing blocks, the serial, one-shot,
+* parallel (with and without a block index) and random-access stream
+* decoders, and the dictionary coder.
+* An untrusted-input check feeds arbitrary bytes to every decoder and
+* parser. Each of these must fail cleanly or stay within its output
+* buffer; decoders that accept the same bytes must agree with each other;
+* the table decoder must match the tree walk bit for bit. Out-of-bounds
+* accesses are left to the sanitizers to catch (build with
+* -fsanitize=address,undefined).
+*
+* hufFuzzOne runs both checks on one input. Building huf_check.c with
+* -DHUF_FUZZ also defines LLVMFuzzerTestOneInput, so the library links into
+* a libFuzzer binary (clang -fsanitize=fuzzer), or into AFL++ through its
+* libFuzzer driver. The decoders return corrupt input as an error without
+* printing anything, so the fuzzer's output stays quiet; check failures go
+* to standard output.
+*
+* hufCheckCorpus runs the checks on generated inputs, including the
+* shapes that reach the codec's edge cases: empty, one byte, one value,
+* two values, Fibonacci counts that force length-limited codes, every byte
+* value once, and sizes either side of the stream segment and block
+* boundaries. Each compressed stream is also corrupted a few ways and
+* must then either fail to decode or decode to the original.
+*
+* hufCheckThroughput times the main encode and decode modes. It can record
+* the results as a baseline file and fail a later run that falls more than
+* HUF_CHECK_TOLERANCE below that baseline.
+*
+* Baseline format:
+* One "mode MB/s" line per mode. Lines starting with '#' are comments.
+*
+* Dependencies:
+* stddef.h
+* stdint.h
+*****************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+// A mode fails the throughput check below this fraction of its baseline
+#define HUF_CHECK_TOLERANCE 0.85
+
+/*****************************************************************************
+**
+* Function: hufCheckRoundTrip
+*
+* Purpose:
+* Compresses `data` with every encoder and decodes it with every decoder
+* that reads that encoder's output.
+*
+* Returns:
+* int - 0 if every decoder gave back `data`, -1 after printing the first mode that did not (or if memory allocation fails).
+*****************************************************************************/
+int hufCheckRoundTrip(const unsigned char *data, size_t size);
+
+/*****************************************************************************
+**
+* Function: hufCheckUntrusted
+*
+* Purpose:
+* Hands `data` to every decoder and parser as compressed input, as
+* described above. The decoders print errors for most inputs.
+*
+* Returns:
+* int - 0 if the decoders agree, -1 after printing the first disagreement.
+*****************************************************************************/
+int hufCheckUntrusted(const unsigned char *data, size_t size);
+
+// Runs hufCheckRoundTrip and hufCheckUntrusted on `data`. Returns 0, or -1 if either fails.
+int hufFuzzOne(const unsigned char *data, size_t size);
+
+/*****************************************************************************
+**
+* Function: hufCheckCorpus
+*
+* Purpose:
+* Runs `rounds` generated inputs, drawn from `seed`, through
+* hufCheckRoundTrip, and corrupted copies of their compressed streams
+* through the decoders and hufCheckUntrusted. Decoder errors on the
+* corrupted streams are silenced.
+*
+* Returns:
+* int - 0 if every check passed, -1 otherwise (each failure is printed with the generator and size that caused it).
+*****************************************************************************/
+int hufCheckCorpus(int rounds, uint32_t seed);
+
+/*****************************************************************************
+**
+* Function: hufCheckThroughput
+*
+* Purpose:
+* Times each mode on `data` (a generated 4 MB text-like input when NULL),
+* keeping the fastest of `repetitions` runs, and prints its MB/s. With a
+* `baseline` file, either records the results in it (`record` set) or
+* compares against it.
+*
+* Returns:
+* int - 0, or -1 if a mode failed its round trip, ran below HUF_CHECK_TOLERANCE of its baseline, or the baseline cannot be read or written.
+*****************************************************************************/
+int hufCheckThroughput(const unsigned char *data, size_t size, int repetitions, const char *baseline, int record);
+
+#endif //HUF_CHECK_H
@@ -0,0 +1,234 @@
+#include <stdlib.h>
+#include <string.h>
+#include "huf_context.h"
+#include "bit_io.h"
+#include "huf_stream.h"
+
+/*****************************************************************************
+**
+* Filename: huf_context.c
+*
+* Description:
+* The HufContext structure, and one-shot compression and decompression
+* of whole buffers in the stream format of huf_stream.h.
+*
+* Dependencies:
+* stdlib.h
+* string.h
+* huf_context.h
+* bit_io.h
+* huf_stream.h
+*****************************************************************************/
+
+/*****************************************************************************
+**
+* Structure: HufContext
+*
+* Fields:
+* blockSize (size_t) - Input bytes per block when compressing.
+* streamCount (int) - Bit streams per block (HUF_DEFAULT_STREAM_COUNT).
+* contextOrder (int) - Passed to encodeBlock; see hufContextSetContextOrder.
+* arena (HuffmanArena) - Tree storage reused by every block.
+* block (unsigned char*) - Buffer for one encoded block, used when `dst` is too close to full to encode into directly.
+* blockCapacity (size_t) - Bytes allocated for `block`.
+* index (BlockIndex) - Offsets of the blocks of the stream being written; emptied at the start of every call.
+*****************************************************************************/
+struct HufContext {
+    size_t blockSize;
+    int streamCount;
+    int contextOrder;
+    HuffmanArena arena;
+    unsigned char *block;
+    size_t blockCapacity;
+    BlockIndex index;
+};
+
+// HufWriteFn context that appends to a caller's buffer
+typedef struct {
+    unsigned char *dst;
+    size_t capacity;
+    size_t size;
+} MemorySink;
+
+static int writeToMemory(void *context, const unsigned char *data, size_t size) {
+    MemorySink *sink = context;
+    if (size > sink->capacity - sink->size) {
+        return -1;
+    }
+    memcpy(sink->dst + sink->size, data, size);
+    sink->size += size;
+    return 0;
+}
+
+HufContext *hufContextCreate(size_t blockSize) {
+    HufContext *context = calloc(1, sizeof *context);
+    if (context == NULL) {
+        return NULL;
+    }
+    context->streamCount = HUF_DEFAULT_STREAM_COUNT;
+    if (initArena(&context->arena, 256) != 0 || hufContextReset(context, blockSize) != HUF_OK) {
+        hufContextDestroy(context);
+        return NULL;
+    }
+    return context;
+}
+
+HufError hufContextReset(HufContext *context, size_t blockSize) {
+    if (blockSize == 0) {
+        blockSize = context->blockSize != 0 ? context->blockSize : HUF_DEFAULT_BLOCK_SIZE;
+    }
+    if (blockSize > HUF_MAX_BLOCK_SIZE) {
+        return HUF_ERROR_ARGUMENT;
+    }
+    if (HUF_BLOCK_BOUND(blockSize) > context->blockCapacity) {
+        unsigned char *grown = realloc(context->block, HUF_BLOCK_BOUND(blockSize));
+        if (grown == NULL) {
+            return HUF_ERROR_ALLOCATION;
+        }
+        context->block = grown;
+        context->blockCapacity = HUF_BLOCK_BOUND(blockSize);
+    }
+    context->blockSize = blockSize;
+    context->index.count = 0;
+    context->index.totalSize = 0;
+    return HUF_OK;
+}
+
+HufError hufContextSetContextOrder(HufContext *context, int contextOrder) {
+    if (contextOrder != 0 && contextOrder != 1) {
+        return HUF_ERROR_ARGUMENT;
+    }
+    context->contextOrder = contextOrder;
+    return HUF_OK;
+}
+
+void hufContextDestroy(HufContext *context) {
+    if (context == NULL) {
+        return;
+    }
+    freeArena(&context->arena);
+    freeBlockIndex(&context->index);
+    free(context->block);
+    free(context);
+}
+
+size_t hufCompressBound(size_t size, size_t blockSize) {
+    if (blockSize == 0) {
+        blockSize = HUF_DEFAULT_BLOCK_SIZE;
+    }
+    // encodeBlock stores a block rather than let it grow, so each block costs at most its prefix and type byte
+    size_t blocks = (size + blockSize - 1) / blockSize;
+    return HUF_STREAM_HEADER_SIZE + size + blocks * (HUF_BLOCK_PREFIX_SIZE + 1) + HUF_BLOCK_PREFIX_SIZE +
+           (blocks + 1) * HUF_INDEX_ENTRY_SIZE + HUF_INDEX_TRAILER_SIZE;
+}
+
+HufError hufContextCompress(HufContext *context, const void *src, size_t size, void *dst, size_t capacity, size_t *written) {
+    const unsigned char *in = src;
+    MemorySink sink = {dst, capacity, 0};
+    unsigned char header[HUF_STREAM_HEADER_SIZE];
+    *written = 0;
+    context->index.count = 0;
+    context->index.totalSize = 0;
+    writeStreamHeader(header);
+    if (writeToMemory(&sink, header, sizeof header) != 0) {
+        return HUF_ERROR_DST_TOO_SMALL;
+    }
+
+    for (size_t offset = 0; offset < size; offset += context->blockSize) {
+        size_t blockSize = size - offset < context->blockSize ? size - offset : context->blockSize;
+        if (blockIndexAdd(&context->index, sink.size, (uint32_t)blockSize) != 0) {
+            return HUF_ERROR_ALLOCATION;
+        }
+        // Encode in place while the worst case fits, so only the last blocks of a tight buffer are copied
+        if (sink.capacity - sink.size >= HUF_BLOCK_BOUND(blockSize)) {
+            size_t bytes = encodeBlock(&context->arena, in + offset, blockSize, context->streamCount, context->contextOrder, NULL,
+                                       sink.dst + sink.size);
+            if (bytes == 0) {
+                return HUF_ERROR_ALLOCATION;
+            }
+            sink.size += bytes;
+            continue;
+        }
+        size_t bytes = encodeBlock(&context->arena, in + offset, blockSize, context->streamCount, context->contextOrder, NULL,
+                                   context->block);
+        if (bytes == 0) {
+            return HUF_ERROR_ALLOCATION;
+        }
+        if (writeToMemory(&sink, context->block, bytes) != 0) {
+            return HUF_ERROR_DST_TOO_SMALL;
+        }
+    }
+
+    unsigned char endMarker[HUF_BLOCK_PREFIX_SIZE] = {0};
+    if (blockIndexAdd(&context->index, sink.size, 0) != 0) {
+        return HUF_ERROR_ALLOCATION;
+    }
+    if (writeToMemory(&sink, endMarker, sizeof endMarker) != 0 ||
+        writeBlockIndex(&context->index, writeToMemory, &sink) != 0) {
+        return HUF_ERROR_DST_TOO_SMALL;
+    }
+    *written = sink.size;
+    return HUF_OK;
+}
+
+HufError hufContextDecompress(HufContext *context, const void *src, size_t size, void *dst, size_t capacity, size_t *written) {
+    (void)context; // Decoding needs no state between blocks; the context keeps the interface symmetric
+    const unsigned char *in = src;
+    unsigned char *out = dst;
+    size_t position = HUF_STREAM_HEADER_SIZE;
+    size_t decoded = 0;
+    size_t blocks = 0;
+    BlockTable table = {0};
+    *written = 0;
+    if (size < HUF_STREAM_HEADER_SIZE || checkStreamHeader(in) != 0) {
+        return HUF_ERROR_CORRUPT;
+    }
+
+    for (;;) {
+        size_t rawSize;
+        size_t bodySize;
+        if (size - position < HUF_BLOCK_PREFIX_SIZE || readBlockPrefix(in + position, &rawSize, &bodySize) != 0 ||
+            bodySize > size - position - HUF_BLOCK_PREFIX_SIZE) {
+            return HUF_ERROR_CORRUPT;
+        }
+        if (rawSize == 0) {
+            if (bodySize != 0 || loadLittleEndian32(in + position + 8) != 0) {
+                return HUF_ERROR_CORRUPT;
+            }
+            position += HUF_BLOCK_PREFIX_SIZE;
+            break;
+        }
+        if (rawSize > capacity - decoded) {
+            return HUF_ERROR_DST_TOO_SMALL;
+        }
+        size_t blockDecoded;
+        if (decodeBlock(in + position, HUF_BLOCK_PREFIX_SIZE + bodySize, out + decoded, capacity - decoded, &blockDecoded, &table) != 0) {
+            return HUF_ERROR_CORRUPT;
+        }
+        position += HUF_BLOCK_PREFIX_SIZE + bodySize;
+        decoded += blockDecoded;
+        blocks++;
+    }
+
+    // Whatever follows the end marker must be the index of exactly these blocks
+    uint64_t totalSize;
+    if (size - position != (blocks + 1) * HUF_INDEX_ENTRY_SIZE + HUF_INDEX_TRAILER_SIZE ||
+        hufDecompressedSize(src, size, &totalSize) != HUF_OK || totalSize != decoded) {
+        return HUF_ERROR_CORRUPT;
+    }
+    *written = decoded;
+    return HUF_OK;
+}
+
+HufError hufDecompressedSize(const void *src, size_t size, uint64_t *decodedSize) {
+    *decodedSize = 0;
+    if (size < HUF_STREAM_HEADER_SIZE + HUF_BLOCK_PREFIX_SIZE + HUF_INDEX_ENTRY_SIZE + HUF_INDEX_TRAILER_SIZE) {
+        return HUF_ERROR_CORRUPT;
+    }
+    const unsigned char *trailer = (const unsigned char *)src + size - HUF_INDEX_TRAILER_SIZE;
+    if (memcmp(trailer + 12, "HIDX", 4) != 0) {
+        return HUF_ERROR_CORRUPT;
+    }
+    *decodedSize = loadLittleEndian64(trailer);
+    return HUF_OK;
+}
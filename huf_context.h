@@ -0,0 +1,125 @@
+#ifndef HUF_CONTEXT_H
+#define HUF_CONTEXT_H
+/*****************************************************************************
+**
+* Filename: huf_context.h
+*
+* Description:
+* Reentrant one-shot interface for embedding the codec. A HufContext owns
+* everything a compression or decompression needs between calls (the tree
+* arena, a block buffer and the block index), so a worker thread can keep
+* one warm context and run any number of calls on it without allocating
+* again. Contexts share no state, so threads with their own context run
+* concurrently. Nothing here exits the process: every failure is returned
+* as a HufError.
+*
+* The output is the block stream of huf_stream.h, so it can be read back
+* with `huf -d`, hufDecompressStream or a HufArchive.
+*
+* Usage:
+* hufContextCreate -> hufContextCompress / hufContextDecompress (any number of times) -> [hufContextReset] -> hufContextDestroy
+*
+* Dependencies:
+* stddef.h
+* stdint.h
+* huf_error.h
+*****************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include "huf_error.h"
+
+// Opaque codec state; see hufContextCreate.
+typedef struct HufContext HufContext;
+
+/*****************************************************************************
+**
+* Function: hufContextCreate
+*
+* Purpose:
+* Allocates a context that compresses in blocks of `blockSize` bytes (0
+* selects HUF_DEFAULT_BLOCK_SIZE). Decompression accepts streams of any
+* block size.
+*
+* Returns:
+* HufContext* - The context, or NULL if `blockSize` exceeds HUF_MAX_BLOCK_SIZE or memory allocation fails.
+*****************************************************************************/
+HufContext *hufContextCreate(size_t blockSize);
+
+/*****************************************************************************
+**
+* Function: hufContextReset
+*
+* Purpose:
+* Returns the context to its freshly created state with a new block size
+* (0 keeps the current one). Buffers are kept, and only grown when the
+* new block size needs more room.
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_ARGUMENT for a block size over HUF_MAX_BLOCK_SIZE, or HUF_ERROR_ALLOCATION (the context keeps its previous block size).
+*****************************************************************************/
+HufError hufContextReset(HufContext *context, size_t blockSize);
+
+/*****************************************************************************
+**
+* Function: hufContextSetContextOrder
+*
+* Purpose:
+* Selects the modelling order of later compressions: 0 (the default)
+* codes every block with one table, 1 also tries order-1 tables per block
+* (see context_model.h) and keeps them where they are smaller. Survives
+* hufContextReset.
+*
+* Returns:
+* HufError - HUF_OK, or HUF_ERROR_ARGUMENT for an order other than 0 or 1.
+*****************************************************************************/
+HufError hufContextSetContextOrder(HufContext *context, int contextOrder);
+
+// Frees the context and its buffers. NULL is ignored.
+void hufContextDestroy(HufContext *context);
+
+// Largest compressed stream for `size` input bytes with blocks of `blockSize` bytes (0 for the default).
+size_t hufCompressBound(size_t size, size_t blockSize);
+
+/*****************************************************************************
+**
+* Function: hufContextCompress
+*
+* Purpose:
+* Compresses `size` bytes of `src` into a complete stream at `dst`: the
+* stream header, the blocks, the end marker and the block index. Blocks
+* are encoded straight into `dst` while it has room for their worst case,
+* and through the context's buffer near the end of it.
+*
+* Returns:
+* HufError - HUF_OK with the stream length in *written, HUF_ERROR_DST_TOO_SMALL, or HUF_ERROR_ALLOCATION.
+*****************************************************************************/
+HufError hufContextCompress(HufContext *context, const void *src, size_t size, void *dst, size_t capacity, size_t *written);
+
+/*****************************************************************************
+**
+* Function: hufContextDecompress
+*
+* Purpose:
+* Decodes the complete stream of `size` bytes at `src` into `dst`,
+* checking every block's checksum. hufDecompressedSize gives the capacity
+* needed beforehand.
+*
+* Returns:
+* HufError - HUF_OK with the decoded length in *written, HUF_ERROR_DST_TOO_SMALL, or HUF_ERROR_CORRUPT.
+*****************************************************************************/
+HufError hufContextDecompress(HufContext *context, const void *src, size_t size, void *dst, size_t capacity, size_t *written);
+
+/*****************************************************************************
+**
+* Function: hufDecompressedSize
+*
+* Purpose:
+* Reads the original size from the trailer of a complete stream without
+* decoding it.
+*
+* Returns:
+* HufError - HUF_OK with the size in *decodedSize, or HUF_ERROR_CORRUPT if `src` does not end with a block index trailer.
+*****************************************************************************/
+HufError hufDecompressedSize(const void *src, size_t size, uint64_t *decodedSize);
+
+#endif //HUF_CONTEXT_H
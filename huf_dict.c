@@ -0,0 +1,131 @@
+#include <string.h>
+#include "huf_dict.h"
+#include "bit_io.h"
+#include "canonical.h"
+#include "crc32c.h"
+#include "histogram.h"
+
+/*****************************************************************************
+**
+* Filename: huf_dict.c
+*
+* Description:
+* Dictionary training, the saved dictionary format, and record coding
+* with the marker bit.
+*
+* Dependencies:
+* string.h
+* huf_dict.h
+* bit_io.h
+* canonical.h
+* crc32c.h
+* histogram.h
+*****************************************************************************/
+
+static const unsigned char dictMagic[4] = {'H', 'U', 'F', 'D'};
+
+// Fills in the codes and decode table for dict->lengths
+static int buildDictTables(HufDictionary *dict) {
+    if (canonicalCodes(dict->lengths, dict->codes) != 0) {
+        return -1;
+    }
+    return buildDecodeTableFromCodes(&dict->table, dict->codes);
+}
+
+int hufDictTrain(HufDictionary *dict, uint32_t id, const unsigned char *const samples[], const size_t sampleSizes[],
+                 size_t sampleCount) {
+    memset(dict, 0, sizeof *dict);
+    dict->id = id;
+    uint64_t counts[256] = {0};
+    for (size_t i = 0; i < sampleCount; i++) {
+        countHistogram(samples[i], sampleSizes[i], counts);
+    }
+
+    // Every byte gets a code: the ones missing from the samples count once, which puts them among the longest codes
+    node_t nodes[256];
+    for (int symbol = 0; symbol < 256; symbol++) {
+        nodes[symbol].index = symbol;
+        nodes[symbol].weight = counts[symbol] > 0 ? counts[symbol] : 1;
+    }
+    if (limitedCodeLengths(nodes, 256, HUF_DICT_MAX_CODE_LENGTH, dict->lengths) != 0 || buildDictTables(dict) != 0) {
+        hufDictFree(dict);
+        return -1;
+    }
+    return 0;
+}
+
+size_t hufDictSave(const HufDictionary *dict, unsigned char *out) {
+    memcpy(out, dictMagic, sizeof dictMagic);
+    out[4] = HUF_DICT_VERSION;
+    out[5] = out[6] = out[7] = 0;
+    storeLittleEndian32(out + 8, dict->id);
+    size_t bytes = 12 + writeCodeLengthHeader(dict->lengths, out + 12);
+    storeLittleEndian32(out + bytes, crc32c(0, out, bytes));
+    return bytes + 4;
+}
+
+long hufDictLoad(HufDictionary *dict, const unsigned char *in, size_t size) {
+    memset(dict, 0, sizeof *dict);
+    if (size < 12 || memcmp(in, dictMagic, sizeof dictMagic) != 0 || in[4] != HUF_DICT_VERSION) {
+        return -1;
+    }
+    long headerBytes = readCodeLengthHeader(in + 12, size - 12, dict->lengths);
+    if (headerBytes < 0 || size - 12 - (size_t)headerBytes < 4) {
+        return -1;
+    }
+    size_t bytes = 12 + (size_t)headerBytes;
+    if (crc32c(0, in, bytes) != loadLittleEndian32(in + bytes)) {
+        return -1;
+    }
+    for (int symbol = 0; symbol < 256; symbol++) {
+        if (dict->lengths[symbol] == 0 || dict->lengths[symbol] > HUF_DICT_MAX_CODE_LENGTH) {
+            return -1;
+        }
+    }
+    dict->id = loadLittleEndian32(in + 8);
+    if (buildDictTables(dict) != 0) {
+        hufDictFree(dict);
+        return -1;
+    }
+    return (long)(bytes + 4);
+}
+
+size_t hufDictEncode(const HufDictionary *dict, const unsigned char *src, size_t size, unsigned char *dst) {
+    uint64_t bits = encodeWithCodes(dict->codes, src, size, dst);
+    // The payload ends zero-padded, so the marker can be or-ed into its last byte (or start a new one)
+    size_t last = (size_t)(bits / 8);
+    unsigned char marker = (unsigned char)(0x80 >> (bits % 8));
+    dst[last] = bits % 8 == 0 ? marker : (unsigned char)(dst[last] | marker);
+    return last + 1;
+}
+
+long hufDictDecode(const HufDictionary *dict, const unsigned char *src, size_t size, unsigned char *dst, size_t capacity) {
+    if (size == 0 || src[size - 1] == 0) {
+        return -1;
+    }
+    uint64_t bitLength = (uint64_t)(size - 1) * 8 + 7 - (unsigned)__builtin_ctz(src[size - 1]);
+    size_t decoded = decodeWithTable(&dict->table, src, bitLength, (char *)dst, capacity);
+
+    // decodeWithTable stops early on an invalid code or a full buffer, so the codes decoded must cover every bit
+    uint64_t usedBits = 0;
+    for (size_t i = 0; i < decoded; i++) {
+        usedBits += dict->lengths[dst[i]];
+    }
+    if (usedBits != bitLength) {
+        return -1;
+    }
+    return (long)decoded;
+}
+
+HufDictionary *hufDictFind(HufDictionary dicts[], size_t count, uint32_t id) {
+    for (size_t i = 0; i < count; i++) {
+        if (dicts[i].id == id) {
+            return &dicts[i];
+        }
+    }
+    return NULL;
+}
+
+void hufDictFree(HufDictionary *dict) {
+    freeDecodeTable(&dict->table);
+}
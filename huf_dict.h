@@ -0,0 +1,145 @@
+#ifndef HUF_DICT_H
+#define HUF_DICT_H
+/*****************************************************************************
+**
+* Filename: huf_dict.h
+*
+* Description:
+* Dictionary mode for many small records with similar statistics. A code
+* table is trained once from sample records, saved, and loaded by every
+* process that encodes or decodes them. Records are then coded against the
+* loaded table: no counting, no tree and no code-length header per record,
+* only the packed codes.
+*
+* Bytes that never occur in the samples are given a count of one before
+* the code lengths are computed, so every byte value has a code (one of
+* the longest) and any record can be encoded; no escape symbol is needed.
+* Code lengths are limited to HUF_DICT_MAX_CODE_LENGTH, so a record grows
+* by at most that many bits per byte when it looks nothing like the
+* samples.
+*
+* Record format:
+* The packed codes, then a single 1 bit, then zero bits up to the next
+* byte boundary. The marker bit lets the decoder find the exact bit length
+* from the record's byte length, which the caller's own framing (a message
+* length, a database column) already provides, so nothing else is stored.
+* Records carry no dictionary ID either; the caller keeps it next to the
+* record if several dictionaries are in use (see hufDictFind).
+*
+* Saved dictionary format:
+* "HUFD", the format version (1 byte), 3 reserved zero bytes, the
+* dictionary ID (4 bytes, little-endian), the 256 code lengths in the
+* format of canonical.h, and the CRC-32C of everything before it (4 bytes,
+* little-endian).
+*
+* Usage:
+* hufDictTrain or hufDictLoad -> [hufDictSave] -> hufDictEncode / hufDictDecode (any number of times, from any number of threads) -> hufDictFree
+*
+* Dependencies:
+* stddef.h
+* stdint.h
+* compress_and_decompress.h
+* decode_table.h
+*****************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include "compress_and_decompress.h"
+#include "decode_table.h"
+
+#define HUF_DICT_VERSION 1
+#define HUF_DICT_MAX_CODE_LENGTH 11
+
+// Largest saved dictionary: fixed fields, a code-length header with one literal per symbol, and the checksum
+#define HUF_DICT_SAVED_MAX (12 + 256 + 4)
+
+// Largest encoded record for `size` input bytes: every byte at the longest code, plus the marker bit
+#define HUF_DICT_RECORD_BOUND(size) (((size_t)(size) * HUF_DICT_MAX_CODE_LENGTH) / 8 + 1)
+
+/*****************************************************************************
+**
+* Structure: HufDictionary
+*
+* Fields:
+* id (uint32_t) - Caller-chosen ID, stored with the saved dictionary.
+* lengths (uint8_t[]) - Code length of every byte value (all non-zero).
+* codes (HuffmanCode[]) - Canonical codes for `lengths`, used by the encoder.
+* table (DecodeTable) - Decode table for `codes`, used by the decoder.
+*****************************************************************************/
+typedef struct {
+    uint32_t id;
+    uint8_t lengths[256];
+    HuffmanCode codes[256];
+    DecodeTable table;
+} HufDictionary;
+
+/*****************************************************************************
+**
+* Function: hufDictTrain
+*
+* Purpose:
+* Counts the bytes of every sample and builds the dictionary's code table
+* and decode table from the combined counts. The samples should look like
+* the records that will be coded; a few hundred kilobytes is plenty.
+*
+* Parameters:
+* dict (HufDictionary*) - Receives the trained dictionary; free it with hufDictFree.
+* id (uint32_t) - The dictionary's ID.
+* samples (const unsigned char* const*) - The sample records.
+* sampleSizes (const size_t*) - Length of each sample.
+* sampleCount (size_t) - Number of samples (may be 0, which gives every byte the same length).
+*
+* Returns:
+* int - 0 on success, -1 if memory allocation fails.
+*****************************************************************************/
+int hufDictTrain(HufDictionary *dict, uint32_t id, const unsigned char *const samples[], const size_t sampleSizes[],
+                 size_t sampleCount);
+
+/*****************************************************************************
+**
+* Function: hufDictSave / hufDictLoad
+*
+* Purpose:
+* Serialize a dictionary in the saved format described above, and rebuild
+* one (codes and decode table) from saved bytes. `out` must hold
+* HUF_DICT_SAVED_MAX bytes.
+*
+* Returns:
+* hufDictSave: size_t - Bytes written.
+* hufDictLoad: long - Bytes consumed, or -1 if the data is truncated, is not a saved dictionary, fails its checksum, or memory allocation fails.
+*****************************************************************************/
+size_t hufDictSave(const HufDictionary *dict, unsigned char *out);
+long hufDictLoad(HufDictionary *dict, const unsigned char *in, size_t size);
+
+/*****************************************************************************
+**
+* Function: hufDictEncode
+*
+* Purpose:
+* Encodes one record with the dictionary's codes. `dst` must hold
+* HUF_DICT_RECORD_BOUND(size) bytes.
+*
+* Returns:
+* size_t - Bytes written (at least 1, for the marker bit).
+*****************************************************************************/
+size_t hufDictEncode(const HufDictionary *dict, const unsigned char *src, size_t size, unsigned char *dst);
+
+/*****************************************************************************
+**
+* Function: hufDictDecode
+*
+* Purpose:
+* Decodes one record of exactly `size` bytes, as returned by
+* hufDictEncode, into `dst`.
+*
+* Returns:
+* long - Bytes decoded, or -1 if the record has no marker bit, holds an invalid code, or does not fit in `capacity` bytes.
+*****************************************************************************/
+long hufDictDecode(const HufDictionary *dict, const unsigned char *src, size_t size, unsigned char *dst, size_t capacity);
+
+// Returns the dictionary with ID `id` among `count` loaded ones, or NULL.
+HufDictionary *hufDictFind(HufDictionary dicts[], size_t count, uint32_t id);
+
+// Releases the dictionary's decode table.
+void hufDictFree(HufDictionary *dict);
+
+#endif //HUF_DICT_H
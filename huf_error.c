@@ -0,0 +1,34 @@
+#include "huf_error.h"
+
+/*****************************************************************************
+**
+* Filename: huf_error.c
+*
+* Description:
+* Descriptions of the HufError codes.
+*
+* Dependencies:
+* huf_error.h
+*****************************************************************************/
+
+const char *hufErrorString(HufError error) {
+    switch (error) {
+        case HUF_OK:
+            return "No error";
+        case HUF_ERROR_ALLOCATION:
+            return "Memory allocation failed";
+        case HUF_ERROR_ARGUMENT:
+            return "Argument out of range";
+        case HUF_ERROR_DST_TOO_SMALL:
+            return "Destination buffer is too small";
+        case HUF_ERROR_CORRUPT:
+            return "Invalid compressed data";
+        case HUF_ERROR_READ:
+            return "Unable to read input";
+        case HUF_ERROR_WRITE:
+            return "Unable to write output";
+        case HUF_ERROR_THREAD:
+            return "Unable to start worker thread";
+    }
+    return "Unknown error";
+}
@@ -0,0 +1,30 @@
+#ifndef HUF_ERROR_H
+#define HUF_ERROR_H
+/*****************************************************************************
+**
+* Filename: huf_error.h
+*
+* Description:
+* Status codes of the codec's entry points. Library code never prints: a
+* failure is returned as one of these, and the caller decides whether and
+* where to report it (the command-line driver prints hufErrorString).
+*
+* Dependencies:
+* None
+*****************************************************************************/
+
+typedef enum {
+    HUF_OK = 0,
+    HUF_ERROR_ALLOCATION,     // Memory allocation failed
+    HUF_ERROR_ARGUMENT,       // A parameter is out of range
+    HUF_ERROR_DST_TOO_SMALL,  // The output does not fit in the destination buffer
+    HUF_ERROR_CORRUPT,        // The input is not a compressed stream, is truncated, or fails a checksum
+    HUF_ERROR_READ,           // Reading the input failed
+    HUF_ERROR_WRITE,          // Writing the output failed (or the write callback refused it)
+    HUF_ERROR_THREAD          // A worker thread could not be started
+} HufError;
+
+// Returns a short description of `error`.
+const char *hufErrorString(HufError error);
+
+#endif //HUF_ERROR_H
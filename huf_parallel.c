@@ -0,0 +1,503 @@
+#include <stdlib.h>
+#include <string.h>
+#include "huf_parallel.h"
+#include "thread_pool.h"
+#include "io_pipeline.h"
+#include "file_input.h"
+#include "huf_stats.h"
+
+/*****************************************************************************
+**
+* Filename: huf_parallel.c
+*
+* Description:
+* Pipeline stages for the parallel encoder and decoder. Each slot of the
+* IoPipeline holds one batch: the reader thread reads (or, for a mapped
+* input, pages in) batch N+1 while the caller codes batch N on the pool,
+* one job per block, and the writer thread writes batch N-1. Blocks still
+* leave in order, so the stream is the same as a batch-at-a-time loop's.
+*
+* Dependencies:
+* stdlib.h
+* string.h
+* huf_parallel.h
+* thread_pool.h
+* io_pipeline.h
+* file_input.h
+* huf_stats.h
+*****************************************************************************/
+
+// Bytes read per batch from an input without a block index, which the stream decoder parses as it goes
+#define HUF_PARALLEL_STREAM_CHUNK ((size_t)256 << 10)
+
+// Pages of a mapped input are touched at this stride so the reader thread takes their faults
+#define HUF_PARALLEL_PAGE_STRIDE 4096
+
+typedef struct {
+    const unsigned char *input;   // The batch's input, blockSize bytes per block
+    size_t inputSize;
+    size_t blockSize;
+    int contextOrder;
+    unsigned char **outputs;      // One HUF_BLOCK_BOUND(blockSize) buffer per job
+    size_t *outputSizes;          // 0 marks a failed block
+    HuffmanArena *arenas;         // One per worker
+    HufStats *stats;              // One per worker when the caller collects statistics, else NULL
+} EncodeBatch;
+
+typedef struct {
+    const unsigned char *input;   // The batch's encoded blocks, back to back
+    const size_t *blockStarts;    // Offset of each block in `input`, plus the end of the last one
+    unsigned char *output;        // The batch's decoded bytes, back to back
+    const size_t *outputStarts;   // Offset of each block in `output`, plus the end of the last one
+    BlockTable *tables;           // The table each block starts from, for HUF_BLOCK_REPEAT blocks
+    int *failed;
+    HufStats *stats;              // One per worker when the caller collects statistics, else NULL
+} DecodeBatch;
+
+// Pipeline context of hufCompressParallel; the arrays hold one entry per slot
+typedef struct {
+    FILE *in;
+    FILE *out;
+    InputFile mapped;
+    int isMapped;
+    size_t mappedOffset;
+    size_t batchSize;                              // batchBlocks * blockSize
+    int batchBlocks;
+    unsigned char *inputs[IO_PIPELINE_DEPTH];      // Read buffers; NULL when the input is mapped
+    EncodeBatch batches[IO_PIPELINE_DEPTH];
+    int jobs[IO_PIPELINE_DEPTH];
+    ThreadPool *pool;
+    int reuseTables;
+    BlockTable table;                              // The table the next block may reuse, when reuseTables is set
+    BlockIndex index;
+    uint64_t offset;                               // Stream offset of the next block
+} CompressPipeline;
+
+// Pipeline context of hufDecompressParallel; the arrays hold one entry per slot
+typedef struct {
+    FILE *in;
+    FILE *out;
+    BlockIndex index;
+    size_t blockCount;
+    size_t batchBlocks;
+    unsigned char *inputs[IO_PIPELINE_DEPTH];
+    size_t inputCapacities[IO_PIPELINE_DEPTH];
+    unsigned char *outputs[IO_PIPELINE_DEPTH];
+    size_t outputCapacities[IO_PIPELINE_DEPTH];
+    size_t *blockStarts[IO_PIPELINE_DEPTH];
+    size_t *outputStarts[IO_PIPELINE_DEPTH];
+    size_t jobs[IO_PIPELINE_DEPTH];
+    int *failed;
+    BlockTable *tables;
+    BlockTable table;                              // The table the next batch starts from
+    HufStats *stats;
+    ThreadPool *pool;
+} DecompressPipeline;
+
+// Pipeline context for inputs without a block index: the serial stream decoder runs as the process stage
+typedef struct {
+    FILE *in;
+    FILE *out;
+    HufStreamDecoder decoder;
+    unsigned char *inputs[IO_PIPELINE_DEPTH];
+    size_t inputSizes[IO_PIPELINE_DEPTH];
+    unsigned char *outputs[IO_PIPELINE_DEPTH];
+    size_t outputSizes[IO_PIPELINE_DEPTH];
+    size_t outputCapacities[IO_PIPELINE_DEPTH];
+    int slot;                                      // The slot the decoder is writing into
+} StreamPipeline;
+
+// Workers add to their own HufStats (see huf_stats.h); the caller's are merged in when the stream is done
+static HufStats *allocWorkerStats(int threadCount) {
+    return hufStatsCurrent() != NULL ? calloc((size_t)threadCount, sizeof(HufStats)) : NULL;
+}
+
+static void mergeWorkerStats(HufStats *stats, int threadCount) {
+    for (int worker = 0; stats != NULL && worker < threadCount; worker++) {
+        hufStatsMerge(hufStatsCurrent(), &stats[worker]);
+    }
+    free(stats);
+}
+
+static void encodeJob(void *context, int job, int worker) {
+    EncodeBatch *batch = context;
+    size_t start = (size_t)job * batch->blockSize;
+    size_t size = batch->inputSize - start < batch->blockSize ? batch->inputSize - start : batch->blockSize;
+    HufStats *previous = hufStatsAttach(batch->stats != NULL ? &batch->stats[worker] : NULL);
+    batch->outputSizes[job] = encodeBlock(&batch->arenas[worker], batch->input + start, size,
+                                          HUF_DEFAULT_STREAM_COUNT, batch->contextOrder, NULL, batch->outputs[job]);
+    hufStatsAttach(previous);
+}
+
+static void decodeJob(void *context, int job, int worker) {
+    DecodeBatch *batch = context;
+    size_t rawSize = batch->outputStarts[job + 1] - batch->outputStarts[job];
+    size_t decodedSize;
+    HufStats *previous = hufStatsAttach(batch->stats != NULL ? &batch->stats[worker] : NULL);
+    // The index sized the output, so a block that decodes to any other size does not match it
+    batch->failed[job] = decodeBlock(batch->input + batch->blockStarts[job], batch->blockStarts[job + 1] - batch->blockStarts[job],
+                                     batch->output + batch->outputStarts[job], rawSize, &decodedSize, &batch->tables[job]) != 0 ||
+                         decodedSize != rawSize;
+    hufStatsAttach(previous);
+}
+
+// The stages fail with the negated HufError, which ioPipelineRun hands back from the first stage to fail
+static int stageError(HufError error) {
+    return -(int)error;
+}
+
+static HufError pipelineError(int result) {
+    return (HufError)-result;
+}
+
+// Reads until `size` bytes arrive or the input ends; returns the bytes read
+static size_t readFully(FILE *in, unsigned char *buffer, size_t size) {
+    size_t total = 0;
+    size_t got;
+    while (total < size && (got = fread(buffer + total, 1, size - total, in)) > 0) {
+        total += got;
+    }
+    return total;
+}
+
+// Grows `*buffer` to at least `size` bytes. Returns 0, or -1 if allocation fails.
+static int reserve(unsigned char **buffer, size_t *capacity, size_t size) {
+    if (size <= *capacity) {
+        return 0;
+    }
+    unsigned char *grown = realloc(*buffer, size);
+    if (grown == NULL) {
+        return -1;
+    }
+    *buffer = grown;
+    *capacity = size;
+    return 0;
+}
+
+static int readEncodeBatch(void *context, int slot, uint64_t sequence) {
+    (void)sequence;
+    CompressPipeline *pipeline = context;
+    EncodeBatch *batch = &pipeline->batches[slot];
+    size_t got;
+    if (pipeline->isMapped) {
+        got = pipeline->mapped.size - pipeline->mappedOffset < pipeline->batchSize ? pipeline->mapped.size - pipeline->mappedOffset
+                                                                                   : pipeline->batchSize;
+        batch->input = pipeline->mapped.data + pipeline->mappedOffset;
+        pipeline->mappedOffset += got;
+        // Touch every page here, so a file that is not cached yet is read from disk off the coding thread
+        volatile unsigned char touched = 0;
+        for (size_t position = 0; position < got; position += HUF_PARALLEL_PAGE_STRIDE) {
+            touched ^= batch->input[position];
+        }
+    } else {
+        got = readFully(pipeline->in, pipeline->inputs[slot], pipeline->batchSize);
+        batch->input = pipeline->inputs[slot];
+        if (got < pipeline->batchSize && ferror(pipeline->in)) {
+            return stageError(HUF_ERROR_READ);
+        }
+    }
+    batch->inputSize = got;
+    pipeline->jobs[slot] = (int)((got + batch->blockSize - 1) / batch->blockSize);
+    return got > 0;
+}
+
+static int encodeBatch(void *context, int slot, uint64_t sequence) {
+    (void)sequence;
+    CompressPipeline *pipeline = context;
+    EncodeBatch *batch = &pipeline->batches[slot];
+    int jobs = pipeline->jobs[slot];
+    if (pipeline->reuseTables) {
+        // Each block depends on the table the one before it left, so the blocks are coded in order on this thread
+        for (int job = 0; job < jobs; job++) {
+            size_t start = (size_t)job * batch->blockSize;
+            size_t size = batch->inputSize - start < batch->blockSize ? batch->inputSize - start : batch->blockSize;
+            batch->outputSizes[job] = encodeBlock(&batch->arenas[0], batch->input + start, size, HUF_DEFAULT_STREAM_COUNT,
+                                                  batch->contextOrder, &pipeline->table, batch->outputs[job]);
+        }
+    } else {
+        threadPoolRun(pipeline->pool, jobs, encodeJob, batch);
+    }
+
+    for (int job = 0; job < jobs; job++) {
+        size_t start = (size_t)job * batch->blockSize;
+        size_t rawSize = batch->inputSize - start < batch->blockSize ? batch->inputSize - start : batch->blockSize;
+        if (batch->outputSizes[job] == 0 || blockIndexAdd(&pipeline->index, pipeline->offset, (uint32_t)rawSize) != 0) {
+            return stageError(HUF_ERROR_ALLOCATION);
+        }
+        pipeline->offset += batch->outputSizes[job];
+    }
+    return 0;
+}
+
+static int writeEncodeBatch(void *context, int slot, uint64_t sequence) {
+    (void)sequence;
+    CompressPipeline *pipeline = context;
+    EncodeBatch *batch = &pipeline->batches[slot];
+    for (int job = 0; job < pipeline->jobs[slot]; job++) {
+        if (writeToFile(pipeline->out, batch->outputs[job], batch->outputSizes[job]) != 0) {
+            return stageError(HUF_ERROR_WRITE);
+        }
+    }
+    return 0;
+}
+
+HufError hufCompressParallel(FILE *in, FILE *out, size_t blockSize, int contextOrder, int reuseTables, int threads) {
+    if (blockSize == 0) {
+        blockSize = HUF_DEFAULT_BLOCK_SIZE;
+    }
+    if (blockSize > HUF_MAX_BLOCK_SIZE) {
+        return HUF_ERROR_ARGUMENT;
+    }
+    ThreadPool pool;
+    HufError status = threadPoolInit(&pool, reuseTables ? 1 : threads);
+    if (status != HUF_OK) {
+        return status;
+    }
+    CompressPipeline pipeline = {0};
+    pipeline.in = in;
+    pipeline.out = out;
+    pipeline.pool = &pool;
+    pipeline.reuseTables = reuseTables;
+    pipeline.batchBlocks = pool.threadCount * HUF_PARALLEL_BATCH_BLOCKS;
+    pipeline.batchSize = (size_t)pipeline.batchBlocks * blockSize;
+    pipeline.offset = HUF_STREAM_HEADER_SIZE;
+
+    // A regular file is mapped and the workers encode straight from the mapping; other inputs are read per batch
+    pipeline.isMapped = mapInputStream(&pipeline.mapped, in) == 0;
+
+    // The slots share the per-worker arenas and statistics, since only one batch is coded at a time
+    HuffmanArena *arenas = calloc((size_t)pool.threadCount, sizeof(HuffmanArena));
+    HufStats *stats = allocWorkerStats(pool.threadCount);
+    status = arenas != NULL ? HUF_OK : HUF_ERROR_ALLOCATION;
+    for (int i = 0; status == HUF_OK && i < pool.threadCount; i++) {
+        status = initArena(&arenas[i], 256) == 0 ? HUF_OK : HUF_ERROR_ALLOCATION;
+    }
+    for (int slot = 0; status == HUF_OK && slot < IO_PIPELINE_DEPTH; slot++) {
+        EncodeBatch *batch = &pipeline.batches[slot];
+        batch->blockSize = blockSize;
+        batch->contextOrder = contextOrder;
+        batch->arenas = arenas;
+        batch->stats = stats;
+        batch->outputs = calloc((size_t)pipeline.batchBlocks, sizeof(unsigned char*));
+        batch->outputSizes = malloc((size_t)pipeline.batchBlocks * sizeof(size_t));
+        pipeline.inputs[slot] = pipeline.isMapped ? NULL : malloc(pipeline.batchSize);
+        status = batch->outputs != NULL && batch->outputSizes != NULL && (pipeline.isMapped || pipeline.inputs[slot] != NULL)
+                     ? HUF_OK : HUF_ERROR_ALLOCATION;
+        for (int i = 0; status == HUF_OK && i < pipeline.batchBlocks; i++) {
+            batch->outputs[i] = malloc(HUF_BLOCK_BOUND(blockSize));
+            status = batch->outputs[i] != NULL ? HUF_OK : HUF_ERROR_ALLOCATION;
+        }
+    }
+
+    if (status == HUF_OK) {
+        unsigned char header[HUF_STREAM_HEADER_SIZE];
+        writeStreamHeader(header);
+        status = writeToFile(out, header, sizeof header) == 0 ? HUF_OK : HUF_ERROR_WRITE;
+    }
+    if (status == HUF_OK) {
+        status = pipelineError(ioPipelineRun(IO_PIPELINE_DEPTH, readEncodeBatch, encodeBatch, writeEncodeBatch, &pipeline));
+    }
+    if (status == HUF_OK) {
+        unsigned char endMarker[HUF_BLOCK_PREFIX_SIZE] = {0};
+        if (blockIndexAdd(&pipeline.index, pipeline.offset, 0) != 0) {
+            status = HUF_ERROR_ALLOCATION;
+        } else if (writeToFile(out, endMarker, sizeof endMarker) != 0 || writeBlockIndex(&pipeline.index, writeToFile, out) != 0) {
+            status = HUF_ERROR_WRITE;
+        }
+    }
+
+    freeBlockIndex(&pipeline.index);
+    for (int slot = 0; slot < IO_PIPELINE_DEPTH; slot++) {
+        for (int i = 0; pipeline.batches[slot].outputs != NULL && i < pipeline.batchBlocks; i++) {
+            free(pipeline.batches[slot].outputs[i]);
+        }
+        free(pipeline.batches[slot].outputs);
+        free(pipeline.batches[slot].outputSizes);
+        free(pipeline.inputs[slot]);
+    }
+    for (int i = 0; arenas != NULL && i < pool.threadCount; i++) {
+        freeArena(&arenas[i]);
+    }
+    mergeWorkerStats(stats, pool.threadCount);
+    free(arenas);
+    if (pipeline.isMapped) {
+        closeInputFile(&pipeline.mapped);
+    }
+    threadPoolFree(&pool);
+    return status;
+}
+
+static int readDecodeBatch(void *context, int slot, uint64_t sequence) {
+    DecompressPipeline *pipeline = context;
+    size_t first = (size_t)sequence * pipeline->batchBlocks;
+    if (first >= pipeline->blockCount) {
+        return 0;
+    }
+    size_t jobs = pipeline->blockCount - first < pipeline->batchBlocks ? pipeline->blockCount - first : pipeline->batchBlocks;
+    size_t *blockStarts = pipeline->blockStarts[slot];
+    size_t *outputStarts = pipeline->outputStarts[slot];
+    pipeline->jobs[slot] = jobs;
+
+    // The index gives every block's position and decoded size, so the batch is read in one go
+    for (size_t job = 0; job <= jobs; job++) {
+        blockStarts[job] = (size_t)(pipeline->index.offsets[first + job] - pipeline->index.offsets[first]);
+        outputStarts[job] = job == 0 ? 0 : outputStarts[job - 1] + pipeline->index.rawSizes[first + job - 1];
+    }
+    if (reserve(&pipeline->inputs[slot], &pipeline->inputCapacities[slot], blockStarts[jobs]) != 0 ||
+        reserve(&pipeline->outputs[slot], &pipeline->outputCapacities[slot], outputStarts[jobs]) != 0) {
+        return stageError(HUF_ERROR_ALLOCATION);
+    }
+    if (fseek(pipeline->in, (long)pipeline->index.offsets[first], SEEK_SET) != 0 ||
+        readFully(pipeline->in, pipeline->inputs[slot], blockStarts[jobs]) != blockStarts[jobs]) {
+        return stageError(ferror(pipeline->in) ? HUF_ERROR_READ : HUF_ERROR_CORRUPT);
+    }
+    return 1;
+}
+
+static int decodeBatch(void *context, int slot, uint64_t sequence) {
+    (void)sequence;
+    DecompressPipeline *pipeline = context;
+    size_t jobs = pipeline->jobs[slot];
+    const unsigned char *input = pipeline->inputs[slot];
+    const size_t *blockStarts = pipeline->blockStarts[slot];
+    const size_t *outputStarts = pipeline->outputStarts[slot];
+
+    // Blocks may reuse the table of an earlier Huffman block, so each job gets a copy of the one it starts from.
+    // readBlockIndex only checked the index against itself, so each block's prefix must also agree with its entry.
+    for (size_t job = 0; job < jobs; job++) {
+        size_t encodedSize = blockStarts[job + 1] - blockStarts[job];
+        size_t rawSize;
+        size_t bodySize;
+        if (encodedSize < HUF_BLOCK_PREFIX_SIZE || readBlockPrefix(input + blockStarts[job], &rawSize, &bodySize) != 0 ||
+            rawSize != outputStarts[job + 1] - outputStarts[job] || HUF_BLOCK_PREFIX_SIZE + bodySize != encodedSize) {
+            return stageError(HUF_ERROR_CORRUPT);
+        }
+        pipeline->tables[job] = pipeline->table;
+        blockTableAdvance(input + blockStarts[job], encodedSize, &pipeline->table);
+    }
+    DecodeBatch batch = {input, blockStarts, pipeline->outputs[slot], outputStarts, pipeline->tables,
+                         pipeline->failed, pipeline->stats};
+    threadPoolRun(pipeline->pool, (int)jobs, decodeJob, &batch);
+    for (size_t job = 0; job < jobs; job++) {
+        if (pipeline->failed[job]) {
+            return stageError(HUF_ERROR_CORRUPT);
+        }
+    }
+    return 0;
+}
+
+static int writeDecodeBatch(void *context, int slot, uint64_t sequence) {
+    (void)sequence;
+    DecompressPipeline *pipeline = context;
+    if (writeToFile(pipeline->out, pipeline->outputs[slot], pipeline->outputStarts[slot][pipeline->jobs[slot]]) != 0) {
+        return stageError(HUF_ERROR_WRITE);
+    }
+    return 0;
+}
+
+// HufWriteFn that collects the stream decoder's output in the current slot, for the writer thread
+static int writeToSlot(void *context, const unsigned char *data, size_t size) {
+    StreamPipeline *pipeline = context;
+    int slot = pipeline->slot;
+    if (reserve(&pipeline->outputs[slot], &pipeline->outputCapacities[slot], pipeline->outputSizes[slot] + size) != 0) {
+        return -1;
+    }
+    memcpy(pipeline->outputs[slot] + pipeline->outputSizes[slot], data, size);
+    pipeline->outputSizes[slot] += size;
+    return 0;
+}
+
+static int readStreamChunk(void *context, int slot, uint64_t sequence) {
+    (void)sequence;
+    StreamPipeline *pipeline = context;
+    pipeline->inputSizes[slot] = readFully(pipeline->in, pipeline->inputs[slot], HUF_PARALLEL_STREAM_CHUNK);
+    if (pipeline->inputSizes[slot] < HUF_PARALLEL_STREAM_CHUNK && ferror(pipeline->in)) {
+        return stageError(HUF_ERROR_READ);
+    }
+    return pipeline->inputSizes[slot] > 0;
+}
+
+static int decodeStreamChunk(void *context, int slot, uint64_t sequence) {
+    (void)sequence;
+    StreamPipeline *pipeline = context;
+    pipeline->slot = slot;
+    pipeline->outputSizes[slot] = 0;
+    return stageError(hufDecoderFeed(&pipeline->decoder, pipeline->inputs[slot], pipeline->inputSizes[slot]));
+}
+
+static int writeStreamChunk(void *context, int slot, uint64_t sequence) {
+    (void)sequence;
+    StreamPipeline *pipeline = context;
+    if (writeToFile(pipeline->out, pipeline->outputs[slot], pipeline->outputSizes[slot]) != 0) {
+        return stageError(HUF_ERROR_WRITE);
+    }
+    return 0;
+}
+
+// Decodes an input without a block index (a pipe, say) front to back, still overlapping the reads and writes
+static HufError decompressUnindexed(FILE *in, FILE *out) {
+    StreamPipeline pipeline = {0};
+    pipeline.in = in;
+    pipeline.out = out;
+    hufDecoderInit(&pipeline.decoder, writeToSlot, &pipeline);
+    HufError status = HUF_OK;
+    for (int slot = 0; status == HUF_OK && slot < IO_PIPELINE_DEPTH; slot++) {
+        pipeline.inputs[slot] = malloc(HUF_PARALLEL_STREAM_CHUNK);
+        status = pipeline.inputs[slot] != NULL ? HUF_OK : HUF_ERROR_ALLOCATION;
+    }
+    if (status == HUF_OK) {
+        status = pipelineError(ioPipelineRun(IO_PIPELINE_DEPTH, readStreamChunk, decodeStreamChunk, writeStreamChunk, &pipeline));
+    }
+    if (status == HUF_OK) {
+        status = hufDecoderFinish(&pipeline.decoder);
+    }
+    for (int slot = 0; slot < IO_PIPELINE_DEPTH; slot++) {
+        free(pipeline.inputs[slot]);
+        free(pipeline.outputs[slot]);
+    }
+    hufDecoderFree(&pipeline.decoder);
+    return status;
+}
+
+HufError hufDecompressParallel(FILE *in, FILE *out, int threads) {
+    DecompressPipeline pipeline = {0};
+    if (readBlockIndex(in, &pipeline.index) != 0) {
+        return decompressUnindexed(in, out); // No index (or a pipe): decode front to back
+    }
+    ThreadPool pool;
+    HufError status = threadPoolInit(&pool, threads);
+    if (status != HUF_OK) {
+        freeBlockIndex(&pipeline.index);
+        return status;
+    }
+    pipeline.in = in;
+    pipeline.out = out;
+    pipeline.pool = &pool;
+    pipeline.blockCount = pipeline.index.count - 1; // The last entry is the end marker
+    pipeline.batchBlocks = (size_t)pool.threadCount * HUF_PARALLEL_BATCH_BLOCKS;
+    pipeline.failed = malloc(pipeline.batchBlocks * sizeof(int));
+    pipeline.tables = malloc(pipeline.batchBlocks * sizeof(BlockTable));
+    pipeline.stats = allocWorkerStats(pool.threadCount);
+    status = pipeline.failed != NULL && pipeline.tables != NULL ? HUF_OK : HUF_ERROR_ALLOCATION;
+    for (int slot = 0; status == HUF_OK && slot < IO_PIPELINE_DEPTH; slot++) {
+        pipeline.blockStarts[slot] = malloc((pipeline.batchBlocks + 1) * sizeof(size_t));
+        pipeline.outputStarts[slot] = malloc((pipeline.batchBlocks + 1) * sizeof(size_t));
+        status = pipeline.blockStarts[slot] != NULL && pipeline.outputStarts[slot] != NULL ? HUF_OK : HUF_ERROR_ALLOCATION;
+    }
+    if (status == HUF_OK) {
+        status = pipelineError(ioPipelineRun(IO_PIPELINE_DEPTH, readDecodeBatch, decodeBatch, writeDecodeBatch, &pipeline));
+    }
+
+    for (int slot = 0; slot < IO_PIPELINE_DEPTH; slot++) {
+        free(pipeline.inputs[slot]);
+        free(pipeline.outputs[slot]);
+        free(pipeline.blockStarts[slot]);
+        free(pipeline.outputStarts[slot]);
+    }
+    free(pipeline.failed);
+    free(pipeline.tables);
+    mergeWorkerStats(pipeline.stats, pool.threadCount);
+    freeBlockIndex(&pipeline.index);
+    threadPoolFree(&pool);
+    return status;
+}
@@ -0,0 +1,72 @@
+#ifndef HUF_PARALLEL_H
+#define HUF_PARALLEL_H
+/*****************************************************************************
+**
+* Filename: huf_parallel.h
+*
+* Description:
+* Block-parallel compression and decompression on a ThreadPool, with the
+* file I/O overlapped on an IoPipeline (see io_pipeline.h). Blocks are
+* independent (each has its own code table), so a batch of blocks is
+* encoded or decoded concurrently while the next batch is read and the
+* previous one written, and the results are written in block order. The
+* output is byte-for-byte the stream hufCompressStream() writes with the
+* same table reuse setting, block index included, and either decoder
+* reads either encoder's output. Table reuse chains each block to the one
+* before it, so the encoder then codes on the calling thread alone and
+* only the I/O overlaps. For streams whose blocks reuse an earlier block's
+* table (HUF_BLOCK_REPEAT), the decoder reads each block's table from the
+* headers before it hands out the batch.
+*
+* The decoder uses the block index at the end of a seekable input to find
+* every block's position and decoded size up front, so it can hand whole
+* batches of blocks to the workers without parsing them first. Inputs
+* without an index (pipes) are decoded front to back by the stream
+* decoder, still with the reads and writes on their own threads.
+*
+* Memory use is bounded by the ring: IO_PIPELINE_DEPTH batches of
+* HUF_PARALLEL_BATCH_BLOCKS blocks per thread, each block with an input
+* and an output buffer. A regular input file is memory-mapped instead (see
+* file_input.h); the reader thread pages in each batch and the workers
+* encode from the mapping without an input buffer.
+*
+* Dependencies:
+* stdio.h
+* huf_stream.h
+*****************************************************************************/
+#include <stdio.h>
+#include "huf_stream.h"
+
+#define HUF_PARALLEL_BATCH_BLOCKS 4
+
+/*****************************************************************************
+**
+* Function: hufCompressParallel
+*
+* Purpose:
+* Compresses `in` to `out` with `threads` threads (including the caller).
+* `blockSize` of 0 selects HUF_DEFAULT_BLOCK_SIZE; `contextOrder` is
+* passed to encodeBlock. Non-zero `reuseTables` lets blocks reuse the
+* previous block's table, as in hufCompressStream(), and codes them on
+* the calling thread whatever `threads` is.
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_ARGUMENT for a block size over HUF_MAX_BLOCK_SIZE, HUF_ERROR_READ, HUF_ERROR_WRITE, HUF_ERROR_ALLOCATION or HUF_ERROR_THREAD.
+*****************************************************************************/
+HufError hufCompressParallel(FILE *in, FILE *out, size_t blockSize, int contextOrder, int reuseTables, int threads);
+
+/*****************************************************************************
+**
+* Function: hufDecompressParallel
+*
+* Purpose:
+* Decompresses `in` to `out`, decoding the blocks of each batch
+* concurrently when `in` is seekable and carries a block index. Reading
+* and writing overlap the decoding either way.
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_CORRUPT for a malformed or truncated stream, HUF_ERROR_READ, HUF_ERROR_WRITE, HUF_ERROR_ALLOCATION or HUF_ERROR_THREAD.
+*****************************************************************************/
+HufError hufDecompressParallel(FILE *in, FILE *out, int threads);
+
+#endif //HUF_PARALLEL_H
@@ -0,0 +1,139 @@
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include "huf_stats.h"
+
+/*****************************************************************************
+**
+* Filename: huf_stats.c
+*
+* Description:
+* The per-thread attachment point, the code-table statistics and the
+* summary helpers. Without HUF_STATS only the helpers that work on a
+* HufStats the caller already has do anything.
+*
+* Dependencies:
+* math.h
+* string.h
+* time.h
+* huf_stats.h
+*****************************************************************************/
+
+#ifdef HUF_STATS
+__thread HufStats *hufStatsSink = NULL;
+
+uint64_t hufStatsNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void hufStatsRecordCodes(const uint64_t counts[256], const uint8_t lengths[256]) {
+    uint64_t total = 0;
+    for (int i = 0; i < 256; i++) {
+        total += counts[i];
+    }
+    for (int i = 0; i < 256; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        double probability = (double)counts[i] / (double)total;
+        hufStatsSink->entropyBits -= (double)counts[i] * log2(probability);
+        hufStatsSink->codeLengthCounts[lengths[i]]++;
+        if (lengths[i] > hufStatsSink->maxCodeLength) {
+            hufStatsSink->maxCodeLength = lengths[i];
+        }
+    }
+    hufStatsSink->symbols += total;
+}
+#endif
+
+int hufStatsEnabled(void) {
+#ifdef HUF_STATS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+HufStats *hufStatsAttach(HufStats *stats) {
+#ifdef HUF_STATS
+    HufStats *previous = hufStatsSink;
+    hufStatsSink = stats;
+    return previous;
+#else
+    (void)stats;
+    return NULL;
+#endif
+}
+
+HufStats *hufStatsCurrent(void) {
+#ifdef HUF_STATS
+    return hufStatsSink;
+#else
+    return NULL;
+#endif
+}
+
+void hufStatsReset(HufStats *stats) {
+    memset(stats, 0, sizeof *stats);
+}
+
+void hufStatsMerge(HufStats *into, const HufStats *from) {
+    for (int stage = 0; stage < HUF_STAGE_COUNT; stage++) {
+        into->stageNanoseconds[stage] += from->stageNanoseconds[stage];
+    }
+    into->blocksEncoded += from->blocksEncoded;
+    into->blocksDecoded += from->blocksDecoded;
+    into->storedBlocks += from->storedBlocks;
+    into->rleBlocks += from->rleBlocks;
+    into->order1Blocks += from->order1Blocks;
+    into->repeatBlocks += from->repeatBlocks;
+    into->encodeIn += from->encodeIn;
+    into->encodeOut += from->encodeOut;
+    into->decodeIn += from->decodeIn;
+    into->decodeOut += from->decodeOut;
+    into->symbols += from->symbols;
+    into->codedBits += from->codedBits;
+    into->entropyBits += from->entropyBits;
+    if (from->maxCodeLength > into->maxCodeLength) {
+        into->maxCodeLength = from->maxCodeLength;
+    }
+    for (int length = 0; length < MAX; length++) {
+        into->codeLengthCounts[length] += from->codeLengthCounts[length];
+    }
+    into->nodeAllocations += from->nodeAllocations;
+    into->queueAllocations += from->queueAllocations;
+}
+
+double hufStatsBitsPerSymbol(const HufStats *stats) {
+    return stats->symbols > 0 ? (double)stats->codedBits / (double)stats->symbols : 0;
+}
+
+double hufStatsEntropyPerSymbol(const HufStats *stats) {
+    return stats->symbols > 0 ? stats->entropyBits / (double)stats->symbols : 0;
+}
+
+void hufStatsPrint(const HufStats *stats, FILE *out) {
+    static const char *stageNames[HUF_STAGE_COUNT] = {"histogram", "tree", "codes", "encode", "decode", "checksum"};
+    for (int stage = 0; stage < HUF_STAGE_COUNT; stage++) {
+        fprintf(out, "  %-10s %12.3f ms\n", stageNames[stage], (double)stats->stageNanoseconds[stage] / 1e6);
+    }
+    fprintf(out, "  encoded    %llu blocks (%llu stored, %llu RLE, %llu order-1, %llu repeated tables), %llu -> %llu bytes\n",
+            (unsigned long long)stats->blocksEncoded, (unsigned long long)stats->storedBlocks,
+            (unsigned long long)stats->rleBlocks, (unsigned long long)stats->order1Blocks,
+            (unsigned long long)stats->repeatBlocks,
+            (unsigned long long)stats->encodeIn, (unsigned long long)stats->encodeOut);
+    fprintf(out, "  decoded    %llu blocks, %llu -> %llu bytes\n", (unsigned long long)stats->blocksDecoded,
+            (unsigned long long)stats->decodeIn, (unsigned long long)stats->decodeOut);
+    fprintf(out, "  bits/symbol %.4f achieved, %.4f entropy, max code length %u\n", hufStatsBitsPerSymbol(stats),
+            hufStatsEntropyPerSymbol(stats), stats->maxCodeLength);
+    fprintf(out, "  code lengths");
+    for (int length = 1; length < MAX; length++) {
+        if (stats->codeLengthCounts[length] > 0) {
+            fprintf(out, " %d:%llu", length, (unsigned long long)stats->codeLengthCounts[length]);
+        }
+    }
+    fprintf(out, "\n  allocations %llu tree nodes, %llu queue nodes\n", (unsigned long long)stats->nodeAllocations,
+            (unsigned long long)stats->queueAllocations);
+}
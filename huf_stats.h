@@ -0,0 +1,153 @@
+#ifndef HUF_STATS_H
+#define HUF_STATS_H
+/*****************************************************************************
+**
+* Filename: huf_stats.h
+*
+* Description:
+* Optional instrumentation of the hot paths. Build with -DHUF_STATS to
+* compile it in; otherwise every HUF_STATS_* macro expands to nothing and
+* hufStatsAttach() does nothing, so the codec pays nothing for it.
+*
+* A caller that wants statistics attaches a HufStats to its thread with
+* hufStatsAttach(). Every stage that runs on that thread then adds its
+* time, byte counts and code statistics to the attached struct, which the
+* caller can read after each block (or reset between blocks). Threads
+* with nothing attached skip the bookkeeping. The parallel drivers
+* collect their workers' statistics into the struct attached to the
+* calling thread.
+*
+* Dependencies:
+* stdio.h
+* stdint.h
+* compress_and_decompress.h
+*****************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include "compress_and_decompress.h"
+
+typedef enum {
+    HUF_STAGE_HISTOGRAM,   // countFrequencies, countBufferFrequencies
+    HUF_STAGE_TREE,        // Tree builds and code lengths
+    HUF_STAGE_CODES,       // HuffmanCodes, canonicalCodes
+    HUF_STAGE_ENCODE,      // Bit packing
+    HUF_STAGE_DECODE,      // Table and tree-walk decoding
+    HUF_STAGE_CHECKSUM,    // Block CRC-32C, on both sides
+    HUF_STAGE_COUNT
+} HufStage;
+
+/*****************************************************************************
+**
+* Structure: HufStats
+*
+* Fields:
+* stageNanoseconds (uint64_t[]) - Time spent in each HufStage.
+* blocksEncoded, blocksDecoded (uint64_t) - Blocks (or whole compress()/decompress() calls) processed.
+* storedBlocks, rleBlocks, order1Blocks, repeatBlocks (uint64_t) - Encoded blocks stored as is, as one repeated byte, with order-1 codes, or with the previous block's code; the code statistics below cover only the blocks with a new order-0 code, except codedBits, which includes all coded blocks.
+* encodeIn, encodeOut (uint64_t) - Input bytes encoded and bytes they were encoded to, headers included.
+* decodeIn, decodeOut (uint64_t) - Encoded bytes read and bytes they decoded to.
+* symbols (uint64_t) - Symbols encoded.
+* codedBits (uint64_t) - Bits those symbols were coded to, headers excluded.
+* entropyBits (double) - Order-0 entropy of each encoded block times its size, summed: the least codedBits could be.
+* maxCodeLength (unsigned) - Longest code used.
+* codeLengthCounts (uint64_t[]) - Number of symbols in the code tables with each code length.
+* nodeAllocations (uint64_t) - HuffmanNodes allocated by createLeafNode and createInternalNodes.
+* queueAllocations (uint64_t) - QueueNodes allocated by priorityEnqueue.
+*****************************************************************************/
+typedef struct {
+    uint64_t stageNanoseconds[HUF_STAGE_COUNT];
+    uint64_t blocksEncoded;
+    uint64_t blocksDecoded;
+    uint64_t storedBlocks;
+    uint64_t rleBlocks;
+    uint64_t order1Blocks;
+    uint64_t repeatBlocks;
+    uint64_t encodeIn;
+    uint64_t encodeOut;
+    uint64_t decodeIn;
+    uint64_t decodeOut;
+    uint64_t symbols;
+    uint64_t codedBits;
+    double entropyBits;
+    unsigned maxCodeLength;
+    uint64_t codeLengthCounts[MAX];
+    uint64_t nodeAllocations;
+    uint64_t queueAllocations;
+} HufStats;
+
+#ifdef HUF_STATS
+extern __thread HufStats *hufStatsSink;
+uint64_t hufStatsNow(void);
+void hufStatsRecordCodes(const uint64_t counts[256], const uint8_t lengths[256]);
+
+// Adds `amount` to a counter of the attached HufStats
+#define HUF_STATS_ADD(field, amount) do { \
+        if (hufStatsSink != NULL) { \
+            hufStatsSink->field += (amount); \
+        } \
+    } while (0)
+// Starts a timer named `name`; HUF_STATS_STAGE adds the time since then to `stage`
+#define HUF_STATS_TIMER(name) uint64_t name = hufStatsSink != NULL ? hufStatsNow() : 0
+#define HUF_STATS_STAGE(stage, name) do { \
+        if (hufStatsSink != NULL) { \
+            hufStatsSink->stageNanoseconds[stage] += hufStatsNow() - (name); \
+        } \
+    } while (0)
+// Records the code length of every symbol in a code table and the entropy of the counts it was built from
+#define HUF_STATS_CODES(counts, lengths) do { \
+        if (hufStatsSink != NULL) { \
+            hufStatsRecordCodes(counts, lengths); \
+        } \
+    } while (0)
+#else
+#define HUF_STATS_ADD(field, amount) ((void)0)
+#define HUF_STATS_TIMER(name) ((void)0)
+#define HUF_STATS_STAGE(stage, name) ((void)0)
+#define HUF_STATS_CODES(counts, lengths) ((void)0)
+#endif
+
+// Returns 1 if the library was built with HUF_STATS, 0 if the statistics are compiled out.
+int hufStatsEnabled(void);
+
+/*****************************************************************************
+**
+* Function: hufStatsAttach
+*
+* Purpose:
+* Makes `stats` the struct this thread's stages add to (NULL stops
+* collecting). The struct is not cleared, so a caller can keep adding to
+* it across blocks or reset it with hufStatsReset between them.
+*
+* Returns:
+* HufStats* - The previously attached struct, so a nested user can restore it; always NULL without HUF_STATS.
+*****************************************************************************/
+HufStats *hufStatsAttach(HufStats *stats);
+
+// Returns the struct attached to this thread, or NULL.
+HufStats *hufStatsCurrent(void);
+
+// Clears every counter in `stats`.
+void hufStatsReset(HufStats *stats);
+
+// Adds every counter of `from` to `into`.
+void hufStatsMerge(HufStats *into, const HufStats *from);
+
+/*****************************************************************************
+**
+* Function: hufStatsBitsPerSymbol / hufStatsEntropyPerSymbol
+*
+* Purpose:
+* The average code length achieved, and the order-0 entropy of the same
+* symbols. When the two are close to 8, or far apart, Huffman coding is
+* the wrong tool for the data.
+*
+* Returns:
+* double - Bits per symbol, or 0 if nothing was encoded.
+*****************************************************************************/
+double hufStatsBitsPerSymbol(const HufStats *stats);
+double hufStatsEntropyPerSymbol(const HufStats *stats);
+
+// Prints a one-screen summary of `stats` to `out`.
+void hufStatsPrint(const HufStats *stats, FILE *out);
+
+#endif //HUF_STATS_H
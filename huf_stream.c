@@ -0,0 +1,423 @@
+#include <stdlib.h>
+#include <string.h>
+#include "huf_stream.h"
+#include "bit_io.h"
+#include "file_input.h"
+
+/*****************************************************************************
+**
+* Filename: huf_stream.c
+*
+* Description:
+* Block-at-a-time stream encoder and decoder, the block index, and
+* FILE-to-FILE drivers.
+*
+* Dependencies:
+* stdlib.h
+* string.h
+* huf_stream.h
+* bit_io.h
+* file_input.h
+*****************************************************************************/
+
+#define HUF_STREAM_CHUNK ((size_t)64 << 10)
+
+static const unsigned char streamMagic[4] = {'H', 'U', 'F', 'S'};
+
+void writeStreamHeader(unsigned char header[HUF_STREAM_HEADER_SIZE]) {
+    memset(header, 0, HUF_STREAM_HEADER_SIZE);
+    memcpy(header, streamMagic, sizeof streamMagic);
+    header[4] = HUF_STREAM_VERSION;
+}
+
+static int isStreamHeader(const unsigned char header[HUF_STREAM_HEADER_SIZE]) {
+    return memcmp(header, streamMagic, sizeof streamMagic) == 0 && header[4] == HUF_STREAM_VERSION && header[5] == 0;
+}
+
+int checkStreamHeader(const unsigned char header[HUF_STREAM_HEADER_SIZE]) {
+    return isStreamHeader(header) ? 0 : -1;
+}
+
+HufError hufEncoderInit(HufStreamEncoder *encoder, size_t blockSize, HufWriteFn write, void *writeContext) {
+    memset(encoder, 0, sizeof *encoder);
+    if (blockSize == 0) {
+        blockSize = HUF_DEFAULT_BLOCK_SIZE;
+    }
+    if (blockSize > HUF_MAX_BLOCK_SIZE) {
+        return HUF_ERROR_ARGUMENT;
+    }
+    encoder->blockSize = blockSize;
+    encoder->streamCount = HUF_DEFAULT_STREAM_COUNT;
+    encoder->contextOrder = 0;
+    encoder->write = write;
+    encoder->writeContext = writeContext;
+    encoder->block = malloc(blockSize);
+    encoder->output = malloc(HUF_BLOCK_BOUND(blockSize));
+    if (encoder->block == NULL || encoder->output == NULL || initArena(&encoder->arena, 256) != 0) {
+        hufEncoderFree(encoder);
+        return HUF_ERROR_ALLOCATION;
+    }
+    unsigned char header[HUF_STREAM_HEADER_SIZE];
+    writeStreamHeader(header);
+    if (write(writeContext, header, sizeof header) != 0) {
+        hufEncoderFree(encoder);
+        return HUF_ERROR_WRITE;
+    }
+    encoder->totalOut = sizeof header;
+    return HUF_OK;
+}
+
+static HufError encodeAndWrite(HufStreamEncoder *encoder, const unsigned char *data, size_t size) {
+    size_t bytes = encodeBlock(&encoder->arena, data, size, encoder->streamCount, encoder->contextOrder,
+                               encoder->reuseTables ? &encoder->table : NULL, encoder->output);
+    if (bytes == 0 || blockIndexAdd(&encoder->index, encoder->totalOut, (uint32_t)size) != 0) {
+        return HUF_ERROR_ALLOCATION;
+    }
+    if (encoder->write(encoder->writeContext, encoder->output, bytes) != 0) {
+        return HUF_ERROR_WRITE;
+    }
+    encoder->totalOut += bytes;
+    return HUF_OK;
+}
+
+HufError hufEncoderFeed(HufStreamEncoder *encoder, const void *data, size_t size) {
+    const unsigned char *in = data;
+    encoder->totalIn += size;
+    while (size > 0) {
+        // Whole blocks are encoded straight from the caller's buffer
+        if (encoder->blockFill == 0 && size >= encoder->blockSize) {
+            HufError status = encodeAndWrite(encoder, in, encoder->blockSize);
+            if (status != HUF_OK) {
+                return status;
+            }
+            in += encoder->blockSize;
+            size -= encoder->blockSize;
+            continue;
+        }
+
+        size_t take = encoder->blockSize - encoder->blockFill;
+        if (take > size) {
+            take = size;
+        }
+        memcpy(encoder->block + encoder->blockFill, in, take);
+        encoder->blockFill += take;
+        in += take;
+        size -= take;
+        if (encoder->blockFill == encoder->blockSize) {
+            HufError status = hufEncoderFlush(encoder);
+            if (status != HUF_OK) {
+                return status;
+            }
+        }
+    }
+    return HUF_OK;
+}
+
+HufError hufEncoderFlush(HufStreamEncoder *encoder) {
+    if (encoder->blockFill == 0) {
+        return HUF_OK;
+    }
+    size_t fill = encoder->blockFill;
+    encoder->blockFill = 0;
+    return encodeAndWrite(encoder, encoder->block, fill);
+}
+
+HufError hufEncoderFinish(HufStreamEncoder *encoder) {
+    unsigned char endMarker[HUF_BLOCK_PREFIX_SIZE] = {0};
+    HufError status = hufEncoderFlush(encoder);
+    if (status != HUF_OK) {
+        return status;
+    }
+    if (blockIndexAdd(&encoder->index, encoder->totalOut, 0) != 0) {
+        return HUF_ERROR_ALLOCATION;
+    }
+    if (encoder->write(encoder->writeContext, endMarker, sizeof endMarker) != 0 ||
+        writeBlockIndex(&encoder->index, encoder->write, encoder->writeContext) != 0) {
+        return HUF_ERROR_WRITE;
+    }
+    encoder->totalOut += sizeof endMarker + encoder->index.count * HUF_INDEX_ENTRY_SIZE + HUF_INDEX_TRAILER_SIZE;
+    return HUF_OK;
+}
+
+void hufEncoderFree(HufStreamEncoder *encoder) {
+    free(encoder->block);
+    free(encoder->output);
+    freeArena(&encoder->arena);
+    freeBlockIndex(&encoder->index);
+    encoder->block = NULL;
+    encoder->output = NULL;
+}
+
+HufError hufDecoderInit(HufStreamDecoder *decoder, HufWriteFn write, void *writeContext) {
+    memset(decoder, 0, sizeof *decoder);
+    decoder->write = write;
+    decoder->writeContext = writeContext;
+    return HUF_OK;
+}
+
+static int growBuffer(unsigned char **buffer, size_t *capacity, size_t needed) {
+    if (needed <= *capacity) {
+        return 0;
+    }
+    unsigned char *grown = realloc(*buffer, needed);
+    if (grown == NULL) {
+        return -1;
+    }
+    *buffer = grown;
+    *capacity = needed;
+    return 0;
+}
+
+HufError hufDecoderFeed(HufStreamDecoder *decoder, const void *data, size_t size) {
+    const unsigned char *in = data;
+    while (size > 0) {
+        if (decoder->finished) {
+            return HUF_OK; // The block index follows the end marker; it is only needed for random access
+        }
+        if (!decoder->headerSeen) {
+            size_t take = HUF_STREAM_HEADER_SIZE - decoder->inputFill < size ? HUF_STREAM_HEADER_SIZE - decoder->inputFill : size;
+            if (growBuffer(&decoder->input, &decoder->inputCapacity, HUF_STREAM_HEADER_SIZE) != 0) {
+                return HUF_ERROR_ALLOCATION;
+            }
+            memcpy(decoder->input + decoder->inputFill, in, take);
+            decoder->inputFill += take;
+            in += take;
+            size -= take;
+            if (decoder->inputFill == HUF_STREAM_HEADER_SIZE) {
+                if (checkStreamHeader(decoder->input) != 0) {
+                    return HUF_ERROR_CORRUPT;
+                }
+                decoder->headerSeen = 1;
+                decoder->inputFill = 0;
+            }
+            continue;
+        }
+
+        // Collect the prefix first, then the rest of the block it announces
+        size_t needed = HUF_BLOCK_PREFIX_SIZE;
+        size_t rawSize = 0;
+        size_t bodySize = 0;
+        if (decoder->inputFill >= HUF_BLOCK_PREFIX_SIZE) {
+            readBlockPrefix(decoder->input, &rawSize, &bodySize);
+            needed += bodySize;
+        }
+        if (growBuffer(&decoder->input, &decoder->inputCapacity, needed) != 0) {
+            return HUF_ERROR_ALLOCATION;
+        }
+        size_t take = needed - decoder->inputFill;
+        if (take > size) {
+            take = size;
+        }
+        memcpy(decoder->input + decoder->inputFill, in, take);
+        decoder->inputFill += take;
+        in += take;
+        size -= take;
+        if (decoder->inputFill < needed) {
+            continue;
+        }
+
+        if (needed == HUF_BLOCK_PREFIX_SIZE) {
+            if (readBlockPrefix(decoder->input, &rawSize, &bodySize) != 0 || (rawSize > 0 && bodySize == 0)) {
+                return HUF_ERROR_CORRUPT;
+            }
+            if (rawSize == 0) {
+                decoder->finished = bodySize == 0 && loadLittleEndian32(decoder->input + 8) == 0;
+                decoder->inputFill = 0;
+                if (!decoder->finished) {
+                    return HUF_ERROR_CORRUPT;
+                }
+            }
+            continue; // Go on to collect the body
+        }
+
+        // A whole block is buffered: decode and write it
+        size_t decodedSize;
+        if (growBuffer(&decoder->output, &decoder->outputCapacity, rawSize) != 0) {
+            return HUF_ERROR_ALLOCATION;
+        }
+        if (decodeBlock(decoder->input, decoder->inputFill, decoder->output, rawSize, &decodedSize, &decoder->table) != 0) {
+            return HUF_ERROR_CORRUPT;
+        }
+        if (decoder->write(decoder->writeContext, decoder->output, decodedSize) != 0) {
+            return HUF_ERROR_WRITE;
+        }
+        decoder->totalOut += decodedSize;
+        decoder->inputFill = 0;
+    }
+    return HUF_OK;
+}
+
+HufError hufDecoderFinish(HufStreamDecoder *decoder) {
+    return decoder->finished ? HUF_OK : HUF_ERROR_CORRUPT;
+}
+
+void hufDecoderFree(HufStreamDecoder *decoder) {
+    free(decoder->input);
+    free(decoder->output);
+    decoder->input = NULL;
+    decoder->output = NULL;
+}
+
+int blockIndexAdd(BlockIndex *index, uint64_t offset, uint32_t rawSize) {
+    if (index->count == index->capacity) {
+        size_t capacity = index->capacity ? index->capacity * 2 : 64;
+        uint64_t *offsets = realloc(index->offsets, capacity * sizeof(uint64_t));
+        if (offsets == NULL) {
+            return -1;
+        }
+        index->offsets = offsets;
+        uint32_t *rawSizes = realloc(index->rawSizes, capacity * sizeof(uint32_t));
+        if (rawSizes == NULL) {
+            return -1;
+        }
+        index->rawSizes = rawSizes;
+        index->capacity = capacity;
+    }
+    index->offsets[index->count] = offset;
+    index->rawSizes[index->count] = rawSize;
+    index->totalSize += rawSize;
+    index->count++;
+    return 0;
+}
+
+int writeBlockIndex(const BlockIndex *index, HufWriteFn write, void *writeContext) {
+    unsigned char entry[HUF_INDEX_ENTRY_SIZE];
+    for (size_t i = 0; i < index->count; i++) {
+        storeLittleEndian64(entry, index->offsets[i]);
+        storeLittleEndian32(entry + 8, index->rawSizes[i]);
+        if (write(writeContext, entry, sizeof entry) != 0) {
+            return -1;
+        }
+    }
+    unsigned char trailer[HUF_INDEX_TRAILER_SIZE];
+    storeLittleEndian64(trailer, index->totalSize);
+    storeLittleEndian32(trailer + 8, (uint32_t)index->count);
+    memcpy(trailer + 12, "HIDX", 4);
+    return write(writeContext, trailer, sizeof trailer);
+}
+
+int readBlockIndex(FILE *in, BlockIndex *index) {
+    unsigned char header[HUF_STREAM_HEADER_SIZE];
+    unsigned char trailer[HUF_INDEX_TRAILER_SIZE];
+    memset(index, 0, sizeof *index);
+    if (fseek(in, 0, SEEK_END) != 0) {
+        return -1; // Not seekable (a pipe)
+    }
+    long size = ftell(in);
+    if (size < HUF_STREAM_HEADER_SIZE + HUF_INDEX_TRAILER_SIZE || fseek(in, 0, SEEK_SET) != 0 ||
+        fread(header, 1, sizeof header, in) != sizeof header || !isStreamHeader(header) ||
+        fseek(in, size - HUF_INDEX_TRAILER_SIZE, SEEK_SET) != 0 ||
+        fread(trailer, 1, sizeof trailer, in) != sizeof trailer || memcmp(trailer + 12, "HIDX", 4) != 0) {
+        fseek(in, 0, SEEK_SET);
+        return -1;
+    }
+
+    size_t count = loadLittleEndian32(trailer + 8);
+    long indexStart = size - HUF_INDEX_TRAILER_SIZE - (long)(count * HUF_INDEX_ENTRY_SIZE);
+    if (count == 0 || count > (size_t)size / HUF_INDEX_ENTRY_SIZE || indexStart < HUF_STREAM_HEADER_SIZE + HUF_BLOCK_PREFIX_SIZE ||
+        fseek(in, indexStart, SEEK_SET) != 0) {
+        fseek(in, 0, SEEK_SET);
+        return -1;
+    }
+    unsigned char entry[HUF_INDEX_ENTRY_SIZE];
+    for (size_t i = 0; i < count; i++) {
+        if (fread(entry, 1, sizeof entry, in) != sizeof entry ||
+            blockIndexAdd(index, loadLittleEndian64(entry), loadLittleEndian32(entry + 8)) != 0) {
+            freeBlockIndex(index);
+            fseek(in, 0, SEEK_SET);
+            return -1;
+        }
+    }
+
+    // Blocks must be in order from the end of the header, the last entry must be the end marker right
+    // before the index, and the sizes must add up to the original size
+    int valid = index->offsets[0] == HUF_STREAM_HEADER_SIZE && index->rawSizes[count - 1] == 0 &&
+                index->offsets[count - 1] + HUF_BLOCK_PREFIX_SIZE == (uint64_t)indexStart &&
+                index->totalSize == loadLittleEndian64(trailer);
+    for (size_t i = 1; valid && i < count; i++) {
+        valid = index->offsets[i] > index->offsets[i - 1] && index->rawSizes[i - 1] > 0 &&
+                index->rawSizes[i - 1] <= HUF_MAX_BLOCK_SIZE;
+    }
+    fseek(in, 0, SEEK_SET);
+    if (!valid) {
+        freeBlockIndex(index);
+        return -1;
+    }
+    return 0;
+}
+
+void freeBlockIndex(BlockIndex *index) {
+    free(index->offsets);
+    free(index->rawSizes);
+    index->offsets = NULL;
+    index->rawSizes = NULL;
+    index->totalSize = 0;
+    index->count = 0;
+    index->capacity = 0;
+}
+
+int writeToFile(void *context, const unsigned char *data, size_t size) {
+    // Empty batches and pipeline slots pass no buffer, and fwrite may not be given a null one even for no bytes
+    if (size == 0) {
+        return 0;
+    }
+    return fwrite(data, 1, size, (FILE*)context) == size ? 0 : -1;
+}
+
+HufError hufCompressStream(FILE *in, FILE *out, size_t blockSize, int contextOrder, int reuseTables) {
+    HufStreamEncoder encoder;
+    HufError status = hufEncoderInit(&encoder, blockSize, writeToFile, out);
+    if (status != HUF_OK) {
+        return status;
+    }
+    encoder.contextOrder = contextOrder;
+    encoder.reuseTables = reuseTables;
+
+    // A regular file is mapped and fed in one call, so whole blocks are encoded straight from the page cache
+    InputFile input;
+    if (mapInputStream(&input, in) == 0) {
+        status = hufEncoderFeed(&encoder, input.data, input.size);
+        closeInputFile(&input);
+        if (status == HUF_OK) {
+            status = hufEncoderFinish(&encoder);
+        }
+        hufEncoderFree(&encoder);
+        return status;
+    }
+
+    unsigned char *chunk = malloc(HUF_STREAM_CHUNK);
+    status = chunk == NULL ? HUF_ERROR_ALLOCATION : HUF_OK;
+    size_t got;
+    while (status == HUF_OK && (got = fread(chunk, 1, HUF_STREAM_CHUNK, in)) > 0) {
+        status = hufEncoderFeed(&encoder, chunk, got);
+    }
+    if (status == HUF_OK && ferror(in)) {
+        status = HUF_ERROR_READ;
+    }
+    if (status == HUF_OK) {
+        status = hufEncoderFinish(&encoder);
+    }
+    free(chunk);
+    hufEncoderFree(&encoder);
+    return status;
+}
+
+HufError hufDecompressStream(FILE *in, FILE *out) {
+    HufStreamDecoder decoder;
+    hufDecoderInit(&decoder, writeToFile, out);
+    unsigned char *chunk = malloc(HUF_STREAM_CHUNK);
+    HufError status = chunk == NULL ? HUF_ERROR_ALLOCATION : HUF_OK;
+    size_t got;
+    while (status == HUF_OK && (got = fread(chunk, 1, HUF_STREAM_CHUNK, in)) > 0) {
+        status = hufDecoderFeed(&decoder, chunk, got);
+    }
+    if (status == HUF_OK && ferror(in)) {
+        status = HUF_ERROR_READ;
+    }
+    if (status == HUF_OK) {
+        status = hufDecoderFinish(&decoder);
+    }
+    free(chunk);
+    hufDecoderFree(&decoder);
+    return status;
+}
@@ -0,0 +1,231 @@
+#ifndef HUF_STREAM_H
+#define HUF_STREAM_H
+/*****************************************************************************
+**
+* Filename: huf_stream.h
+*
+* Description:
+* Streaming compression in bounded memory. The encoder buffers input until
+* it has a full block, encodes the block with encodeBlock() and hands the
+* result to a write callback; the decoder does the reverse. Memory use is a
+* few block-sized buffers no matter how long the input is, and the input
+* is read once, so pipes such as stdin/stdout work.
+*
+* Stream format (version 2; version 1 blocks had no type byte):
+* header - "HUFS", the format version (1 byte), flags (1 byte, 0) and 2 reserved zero bytes.
+* blocks - Any number of blocks (see block_codec.h), each with its own code-length table (or a reference to the last one before it), stream bit lengths and CRC-32C.
+* end marker - A block prefix whose sizes and checksum are all 0.
+* block index - One entry per block plus one for the end marker: offset of the block from the start of the stream (8 bytes) and its rawSize (4 bytes), little-endian.
+* trailer - The original size (8 bytes), the number of index entries (4 bytes), both little-endian, and the tag "HIDX".
+* The original size is in the trailer rather than the header because the
+* encoder only knows it at the end, and the output may be a pipe. Decoders
+* reading the stream front to back stop at the end marker and skip the
+* index; decoders with a seekable input read it from the end to find every
+* block without parsing the ones before it (see huf_archive.h).
+*
+* Usage:
+* init -> feed (any number of times, any chunk size) -> [flush] -> finish -> free
+*
+* Dependencies:
+* stdio.h
+* block_codec.h
+* huf_error.h
+*****************************************************************************/
+#include <stdio.h>
+#include "block_codec.h"
+#include "huf_error.h"
+
+// Receives encoded (or decoded) bytes. Returns 0 on success, non-zero to abort the stream.
+typedef int (*HufWriteFn)(void *context, const unsigned char *data, size_t size);
+
+#define HUF_STREAM_HEADER_SIZE 8
+#define HUF_STREAM_VERSION 2
+#define HUF_INDEX_ENTRY_SIZE 12
+#define HUF_INDEX_TRAILER_SIZE 16
+
+/*****************************************************************************
+**
+* Structure: BlockIndex
+*
+* Fields:
+* offsets (uint64_t*) - Offset of each block from the start of the stream.
+* rawSizes (uint32_t*) - Decoded size of each block (0 for the end marker).
+* count (size_t) - Entries recorded.
+* capacity (size_t) - Entries allocated.
+* totalSize (uint64_t) - Sum of the rawSizes: the original size of the input.
+*****************************************************************************/
+typedef struct {
+    uint64_t *offsets;
+    uint32_t *rawSizes;
+    uint64_t totalSize;
+    size_t count;
+    size_t capacity;
+} BlockIndex;
+
+/*****************************************************************************
+**
+* Structure: HufStreamEncoder
+*
+* Fields:
+* blockSize (size_t) - Input bytes per block.
+* streamCount (int) - Bit streams per block; hufEncoderInit sets HUF_DEFAULT_STREAM_COUNT, and it may be changed before the first feed.
+* contextOrder (int) - 1 lets encodeBlock try order-1 tables (see context_model.h); hufEncoderInit sets 0, and it may be changed before the first feed.
+* reuseTables (int) - Non-zero lets a block reuse the previous block's code table (HUF_BLOCK_REPEAT), coding it in one pass; hufEncoderInit sets 0, and it may be changed before the first feed.
+* table (BlockTable) - The table the next block may reuse.
+* block (unsigned char*) - Buffer collecting the current block's input.
+* blockFill (size_t) - Bytes in `block`.
+* output (unsigned char*) - Buffer for one encoded block (HUF_BLOCK_BOUND(blockSize) bytes).
+* arena (HuffmanArena) - Tree storage reused by every block.
+* write (HufWriteFn) - Output callback.
+* writeContext (void*) - Passed to `write`.
+* totalIn (uint64_t) - Input bytes accepted so far.
+* totalOut (uint64_t) - Encoded bytes written so far.
+* index (BlockIndex) - Offsets of the blocks written so far.
+*****************************************************************************/
+typedef struct {
+    size_t blockSize;
+    int streamCount;
+    int contextOrder;
+    int reuseTables;
+    BlockTable table;
+    unsigned char *block;
+    size_t blockFill;
+    unsigned char *output;
+    HuffmanArena arena;
+    HufWriteFn write;
+    void *writeContext;
+    uint64_t totalIn;
+    uint64_t totalOut;
+    BlockIndex index;
+} HufStreamEncoder;
+
+/*****************************************************************************
+**
+* Structure: HufStreamDecoder
+*
+* Fields:
+* input (unsigned char*) - Buffer collecting the current encoded block.
+* inputFill (size_t) - Bytes in `input`.
+* inputCapacity (size_t) - Bytes allocated for `input`; grows to the largest block seen.
+* output (unsigned char*) - Buffer for one decoded block.
+* outputCapacity (size_t) - Bytes allocated for `output`.
+* write (HufWriteFn) - Output callback.
+* writeContext (void*) - Passed to `write`.
+* headerSeen (int) - Set once the stream header has been read and checked.
+* finished (int) - Set once the end-of-stream marker has been read.
+* table (BlockTable) - The code table of the last Huffman block, for HUF_BLOCK_REPEAT blocks.
+* totalOut (uint64_t) - Decoded bytes written so far.
+*****************************************************************************/
+typedef struct {
+    unsigned char *input;
+    size_t inputFill;
+    size_t inputCapacity;
+    unsigned char *output;
+    size_t outputCapacity;
+    HufWriteFn write;
+    void *writeContext;
+    int headerSeen;
+    int finished;
+    BlockTable table;
+    uint64_t totalOut;
+} HufStreamDecoder;
+
+/*****************************************************************************
+**
+* Function: hufEncoderInit
+*
+* Purpose:
+* Allocates the encoder's buffers and writes the stream header. `blockSize`
+* of 0 selects HUF_DEFAULT_BLOCK_SIZE.
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_ARGUMENT if `blockSize` exceeds HUF_MAX_BLOCK_SIZE, HUF_ERROR_ALLOCATION, or HUF_ERROR_WRITE if the header cannot be written.
+*****************************************************************************/
+HufError hufEncoderInit(HufStreamEncoder *encoder, size_t blockSize, HufWriteFn write, void *writeContext);
+
+// Adds input; every block that fills up is encoded and written. Returns HUF_OK, HUF_ERROR_ALLOCATION or HUF_ERROR_WRITE.
+HufError hufEncoderFeed(HufStreamEncoder *encoder, const void *data, size_t size);
+
+// Encodes and writes the buffered input as a (possibly short) block. Returns as hufEncoderFeed.
+HufError hufEncoderFlush(HufStreamEncoder *encoder);
+
+// Flushes and writes the end-of-stream marker and the block index. Returns as hufEncoderFeed.
+HufError hufEncoderFinish(HufStreamEncoder *encoder);
+
+// Frees the encoder's buffers.
+void hufEncoderFree(HufStreamEncoder *encoder);
+
+/*****************************************************************************
+**
+* Function: hufDecoderInit / hufDecoderFeed / hufDecoderFinish / hufDecoderFree
+*
+* Purpose:
+* hufDecoderFeed accepts encoded bytes in chunks of any size, checks the
+* stream header, and writes each block's decoded bytes as soon as the
+* whole block has arrived and passed its checksum.
+* hufDecoderFinish checks that the end-of-stream marker was seen.
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_CORRUPT for malformed or truncated input, HUF_ERROR_ALLOCATION, or HUF_ERROR_WRITE.
+*****************************************************************************/
+HufError hufDecoderInit(HufStreamDecoder *decoder, HufWriteFn write, void *writeContext);
+HufError hufDecoderFeed(HufStreamDecoder *decoder, const void *data, size_t size);
+HufError hufDecoderFinish(HufStreamDecoder *decoder);
+void hufDecoderFree(HufStreamDecoder *decoder);
+
+/*****************************************************************************
+**
+* Function: writeStreamHeader / checkStreamHeader
+*
+* Purpose:
+* Write the HUF_STREAM_HEADER_SIZE-byte stream header, and check one that
+* was read back.
+*
+* Returns:
+* checkStreamHeader: int - 0 if the header is valid, -1 for a bad magic number or version.
+*****************************************************************************/
+void writeStreamHeader(unsigned char header[HUF_STREAM_HEADER_SIZE]);
+int checkStreamHeader(const unsigned char header[HUF_STREAM_HEADER_SIZE]);
+
+/*****************************************************************************
+**
+* Function: blockIndexAdd / writeBlockIndex / readBlockIndex / freeBlockIndex
+*
+* Purpose:
+* Record block offsets while encoding and write them as the stream's index;
+* readBlockIndex checks the stream header, then loads and validates the
+* index from the end of a seekable stream (the file position is left at the
+* start of the stream). That validation only checks the index against
+* itself: the offsets increase and the sizes add up. Its consumers (the
+* parallel decoder and the archive reader) also check each block's prefix
+* against its entry before they trust the entry's sizes.
+*
+* Returns:
+* int - 0 on success; -1 on allocation or write failure, or (for readBlockIndex) when `in` is not seekable or has no valid index.
+*****************************************************************************/
+int blockIndexAdd(BlockIndex *index, uint64_t offset, uint32_t rawSize);
+int writeBlockIndex(const BlockIndex *index, HufWriteFn write, void *writeContext);
+int readBlockIndex(FILE *in, BlockIndex *index);
+void freeBlockIndex(BlockIndex *index);
+
+// HufWriteFn that appends to the FILE* passed as context; a zero-length write does nothing, so `data` may then be NULL.
+int writeToFile(void *context, const unsigned char *data, size_t size);
+
+/*****************************************************************************
+**
+* Function: hufCompressStream / hufDecompressStream
+*
+* Purpose:
+* Run the stream encoder/decoder from one FILE to another (files, pipes,
+* stdin/stdout), reading in fixed-size chunks. hufCompressStream maps a
+* regular input file instead (see file_input.h) and encodes its blocks in
+* place. `contextOrder` and `reuseTables` set the encoder's fields of the
+* same names.
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_READ or HUF_ERROR_WRITE for a failed read or write, or any error of the encoder or decoder.
+*****************************************************************************/
+HufError hufCompressStream(FILE *in, FILE *out, size_t blockSize, int contextOrder, int reuseTables);
+HufError hufDecompressStream(FILE *in, FILE *out);
+
+#endif //HUF_STREAM_H
@@ -0,0 +1,133 @@
+#include <stdlib.h>
+#include "huffman_arena.h"
+
+/*****************************************************************************
+**
+* Filename: huffman_arena.c
+*
+* Description:
+* Arena storage, the in-place leaf sort and two-queue build, and the
+* depth pass that turns an arena tree into code lengths.
+*
+* Dependencies:
+* stdlib.h
+* huffman_arena.h
+*****************************************************************************/
+
+int initArena(HuffmanArena *arena, int maxSymbols) {
+    size_t capacity = maxSymbols > 0 ? 2 * (size_t)maxSymbols - 1 : 1;
+    arena->nodes = (ArenaNode*)malloc(capacity * sizeof(ArenaNode));
+    if (arena->nodes == NULL) {
+        arena->size = 0;
+        arena->maxSymbols = 0;
+        return -1;
+    }
+    arena->size = 0;
+    arena->maxSymbols = maxSymbols;
+    return 0;
+}
+
+void resetArena(HuffmanArena *arena) {
+    arena->size = 0;
+}
+
+void freeArena(HuffmanArena *arena) {
+    free(arena->nodes);
+    arena->nodes = NULL;
+    arena->size = 0;
+    arena->maxSymbols = 0;
+}
+
+static int lighter(const ArenaNode *a, const ArenaNode *b) {
+    return a->frequency < b->frequency || (a->frequency == b->frequency && a->symbol < b->symbol);
+}
+
+static void siftDown(ArenaNode *leaves, int start, int count) {
+    ArenaNode moving = leaves[start];
+    int i = start;
+    while (2 * i + 1 < count) {
+        int child = 2 * i + 1;
+        if (child + 1 < count && lighter(&leaves[child], &leaves[child + 1])) {
+            child++;
+        }
+        if (!lighter(&moving, &leaves[child])) {
+            break;
+        }
+        leaves[i] = leaves[child];
+        i = child;
+    }
+    leaves[i] = moving;
+}
+
+// Heapsort: in place and allocation-free, unlike qsort
+static void sortLeaves(ArenaNode *leaves, int count) {
+    for (int i = count / 2 - 1; i >= 0; i--) {
+        siftDown(leaves, i, count);
+    }
+    for (int end = count - 1; end > 0; end--) {
+        ArenaNode largest = leaves[0];
+        leaves[0] = leaves[end];
+        leaves[end] = largest;
+        siftDown(leaves, 0, end);
+    }
+}
+
+int arenaBuildTree(HuffmanArena *arena, const node_t nodes[], int count) {
+    resetArena(arena);
+    if (count <= 0 || count > arena->maxSymbols) {
+        return -1;
+    }
+
+    ArenaNode *tree = arena->nodes;
+    for (int i = 0; i < count; i++) {
+        tree[i].frequency = nodes[i].weight;
+        tree[i].left = -1;
+        tree[i].right = -1;
+        tree[i].symbol = nodes[i].index;
+    }
+    sortLeaves(tree, count);
+
+    // Leaves [leafFront, count) and internal nodes [internalFront, size) are the two sorted queues
+    int leafFront = 0;
+    int internalFront = count;
+    int size = count;
+    while (size < 2 * count - 1) {
+        int smallest[2];
+        for (int k = 0; k < 2; k++) { // Take the smaller front, preferring leaves on ties
+            if (internalFront == size || (leafFront < count && tree[leafFront].frequency <= tree[internalFront].frequency)) {
+                smallest[k] = leafFront++;
+            } else {
+                smallest[k] = internalFront++;
+            }
+        }
+        tree[size].frequency = tree[smallest[0]].frequency + tree[smallest[1]].frequency;
+        tree[size].left = smallest[0];
+        tree[size].right = smallest[1];
+        tree[size].symbol = -1;
+        size++;
+    }
+    arena->size = size;
+    return size - 1;
+}
+
+int arenaCodeLengths(HuffmanArena *arena, int root, uint8_t lengths[]) {
+    ArenaNode *tree = arena->nodes;
+    if (tree[root].left < 0) {
+        lengths[tree[root].symbol] = 1; // Same 1-bit code HuffmanCodes() gives a lone symbol
+        return 0;
+    }
+
+    tree[root].depth = 0;
+    for (int i = root; i >= 0; i--) {
+        if (tree[i].left < 0) {
+            if (tree[i].depth > HUF_MAX_CODE_LENGTH) {
+                return -1;
+            }
+            lengths[tree[i].symbol] = (uint8_t)tree[i].depth;
+        } else {
+            tree[tree[i].left].depth = tree[i].depth + 1;
+            tree[tree[i].right].depth = tree[i].depth + 1;
+        }
+    }
+    return 0;
+}
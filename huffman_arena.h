@@ -0,0 +1,111 @@
+#ifndef HUFFMAN_ARENA_H
+#define HUFFMAN_ARENA_H
+/*****************************************************************************
+**
+* Filename: huffman_arena.h
+*
+* Description:
+* Arena-backed Huffman tree for the block paths. All 2n-1 nodes of a tree
+* over n symbols live in one contiguous array allocated once by initArena,
+* children are linked by index instead of pointer, and resetArena drops the
+* whole tree in O(1) so the next block reuses the same memory. Building a
+* tree, and turning it into code lengths, performs no allocation.
+*
+* The leaves are sorted in place at the start of the array and the internal
+* nodes are appended behind them in the order they are created, which is
+* also non-decreasing frequency order. The two regions are therefore the
+* two queues of the linear-time two-queue build, and no QueueNode or
+* separate queue storage is needed.
+*
+* Dependencies:
+* compress_and_decompress.h
+*****************************************************************************/
+#include "compress_and_decompress.h"
+
+/*****************************************************************************
+**
+* Structure: ArenaNode
+*
+* Fields:
+* frequency (uint64_t) - Weight of the leaf, or the sum of the weights below an internal node.
+* left (int32_t) - Index of the left child in the arena, or -1 for a leaf.
+* right (int32_t) - Index of the right child in the arena, or -1 for a leaf.
+* symbol (int32_t) - The symbol of a leaf (-1 for internal nodes).
+* depth (int32_t) - Depth below the root, filled in by arenaCodeLengths.
+*****************************************************************************/
+typedef struct {
+    uint64_t frequency;
+    int32_t left;
+    int32_t right;
+    int32_t symbol;
+    int32_t depth;
+} ArenaNode;
+
+/*****************************************************************************
+**
+* Structure: HuffmanArena
+*
+* Fields:
+* nodes (ArenaNode*) - Node storage: leaves first, then internal nodes in creation order.
+* size (int) - Nodes in use by the current tree.
+* maxSymbols (int) - Largest alphabet the arena was sized for (it holds 2 * maxSymbols - 1 nodes).
+*****************************************************************************/
+typedef struct {
+    ArenaNode *nodes;
+    int size;
+    int maxSymbols;
+} HuffmanArena;
+
+/*****************************************************************************
+**
+* Function: initArena
+*
+* Purpose:
+* Allocates room for a tree over up to `maxSymbols` symbols in a single block.
+*
+* Returns:
+* int - 0 on success, -1 if memory allocation fails.
+*****************************************************************************/
+int initArena(HuffmanArena *arena, int maxSymbols);
+
+// Discards the current tree in O(1); the storage is kept for the next build.
+void resetArena(HuffmanArena *arena);
+
+// Frees the arena storage.
+void freeArena(HuffmanArena *arena);
+
+/*****************************************************************************
+**
+* Function: arenaBuildTree
+*
+* Purpose:
+* Resets the arena and builds the Huffman tree for the given symbols: the
+* leaves are heap-sorted in place by frequency (ties by symbol, so the
+* result is deterministic) and merged with the two-queue method.
+*
+* Parameters:
+* arena (HuffmanArena*) - Storage for the tree.
+* nodes (const node_t*) - Symbols and weights, as filled in by countFrequencies().
+* count (int) - Number of entries in `nodes` (at most `arena->maxSymbols`).
+*
+* Returns:
+* int - Index of the root node, or -1 if `count` is 0 or too large for the arena.
+*****************************************************************************/
+int arenaBuildTree(HuffmanArena *arena, const node_t nodes[], int count);
+
+/*****************************************************************************
+**
+* Function: arenaCodeLengths
+*
+* Purpose:
+* Records the depth of every leaf in `lengths`, indexed by symbol (symbols
+* not in the tree are left untouched). Children always sit at lower indices
+* than their parent, so one backwards pass from the root assigns every
+* depth without recursion. A tree with a single leaf gives it length 1.
+*
+* Returns:
+* int - 0 on success, -1 if a leaf is deeper than HUF_MAX_CODE_LENGTH.
+*****************************************************************************/
+int arenaCodeLengths(HuffmanArena *arena, int root, uint8_t lengths[]);
+
+#endif //HUFFMAN_ARENA_H
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include "io_pipeline.h"
+
+/*****************************************************************************
+**
+* Filename: io_pipeline.c
+*
+* Description:
+* Stage loops for the IoPipeline. Each loop waits for the stage before it
+* (or, for the reader, for a free slot), runs its stage with the lock
+* released, and broadcasts the new count. Batches are coarse, so one
+* condition variable for every change is enough.
+*
+* Dependencies:
+* stdio.h
+* io_pipeline.h
+*****************************************************************************/
+
+// Counts one finished batch of a stage, or records its failure, and wakes the other stages. Returns 0, or -1 on failure.
+static int finishBatch(IoPipeline *pipeline, uint64_t *count, int result) {
+    pthread_mutex_lock(&pipeline->lock);
+    if (result < 0) {
+        if (pipeline->failed == 0) {
+            pipeline->failed = result; // Later failures are usually knock-on effects of the first
+        }
+    } else {
+        (*count)++;
+    }
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->lock);
+    return result < 0 ? -1 : 0;
+}
+
+static void *readerMain(void *argument) {
+    IoPipeline *pipeline = argument;
+    for (;;) {
+        pthread_mutex_lock(&pipeline->lock);
+        // A slot is free again once the batch that used it has been written
+        while (!pipeline->failed && pipeline->read - pipeline->written >= (uint64_t)pipeline->depth) {
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+        int failed = pipeline->failed;
+        uint64_t sequence = pipeline->read;
+        pthread_mutex_unlock(&pipeline->lock);
+        if (failed) {
+            return NULL;
+        }
+
+        int result = pipeline->readFn(pipeline->context, (int)(sequence % (uint64_t)pipeline->depth), sequence);
+        if (result == 0) {
+            pthread_mutex_lock(&pipeline->lock);
+            pipeline->inputEnded = 1;
+            pthread_cond_broadcast(&pipeline->changed);
+            pthread_mutex_unlock(&pipeline->lock);
+            return NULL;
+        }
+        if (finishBatch(pipeline, &pipeline->read, result) != 0) {
+            return NULL;
+        }
+    }
+}
+
+static void *writerMain(void *argument) {
+    IoPipeline *pipeline = argument;
+    for (;;) {
+        pthread_mutex_lock(&pipeline->lock);
+        while (!pipeline->failed && pipeline->written == pipeline->processed && !pipeline->processEnded) {
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+        int done = pipeline->failed || pipeline->written == pipeline->processed;
+        uint64_t sequence = pipeline->written;
+        pthread_mutex_unlock(&pipeline->lock);
+        if (done) {
+            return NULL;
+        }
+
+        int result = pipeline->writeFn(pipeline->context, (int)(sequence % (uint64_t)pipeline->depth), sequence);
+        if (finishBatch(pipeline, &pipeline->written, result) != 0) {
+            return NULL;
+        }
+    }
+}
+
+// The process stage, run on the calling thread
+static void processBatches(IoPipeline *pipeline) {
+    for (;;) {
+        pthread_mutex_lock(&pipeline->lock);
+        while (!pipeline->failed && pipeline->processed == pipeline->read && !pipeline->inputEnded) {
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+        int done = pipeline->failed || pipeline->processed == pipeline->read;
+        uint64_t sequence = pipeline->processed;
+        pthread_mutex_unlock(&pipeline->lock);
+        if (done) {
+            break;
+        }
+
+        int result = pipeline->processFn(pipeline->context, (int)(sequence % (uint64_t)pipeline->depth), sequence);
+        if (finishBatch(pipeline, &pipeline->processed, result) != 0) {
+            break;
+        }
+    }
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->processEnded = 1;
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+// Fallback when the I/O threads cannot be started: every batch goes through the three stages in turn, in slot 0
+static int runSerially(IoPipeline *pipeline) {
+    for (uint64_t sequence = 0;; sequence++) {
+        int result = pipeline->readFn(pipeline->context, 0, sequence);
+        if (result <= 0) {
+            return result;
+        }
+        result = pipeline->processFn(pipeline->context, 0, sequence);
+        if (result == 0) {
+            result = pipeline->writeFn(pipeline->context, 0, sequence);
+        }
+        if (result < 0) {
+            return result;
+        }
+    }
+}
+
+int ioPipelineRun(int depth, IoStageFn read, IoStageFn process, IoStageFn write, void *context) {
+    IoPipeline pipeline = {.depth = depth < 1 ? 1 : depth, .readFn = read, .processFn = process, .writeFn = write,
+                           .context = context};
+    pthread_t reader;
+    pthread_t writer;
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pthread_cond_init(&pipeline.changed, NULL);
+
+    // The writer starts first: until the reader runs nothing has been consumed, so either failure can still fall back
+    int result;
+    if (pthread_create(&writer, NULL, writerMain, &pipeline) != 0) {
+        result = runSerially(&pipeline);
+    } else if (pthread_create(&reader, NULL, readerMain, &pipeline) != 0) {
+        pthread_mutex_lock(&pipeline.lock);
+        pipeline.processEnded = 1;
+        pthread_cond_broadcast(&pipeline.changed);
+        pthread_mutex_unlock(&pipeline.lock);
+        pthread_join(writer, NULL);
+        result = runSerially(&pipeline);
+    } else {
+        processBatches(&pipeline);
+        pthread_join(reader, NULL);
+        pthread_join(writer, NULL);
+        result = pipeline.failed;
+    }
+    pthread_mutex_destroy(&pipeline.lock);
+    pthread_cond_destroy(&pipeline.changed);
+    return result;
+}
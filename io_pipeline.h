@@ -0,0 +1,91 @@
+#ifndef IO_PIPELINE_H
+#define IO_PIPELINE_H
+/*****************************************************************************
+**
+* Filename: io_pipeline.h
+*
+* Description:
+* A read -> process -> write pipeline over a ring of `depth` slots. A
+* reader thread fills slots with batches in order, the calling thread
+* processes them, and a writer thread drains them. Reading batch N+1,
+* processing batch N and writing batch N-1 therefore overlap, and a run
+* takes about as long as its slowest stage rather than the sum of all
+* three. The reader waits while every slot is still being processed or
+* written, which bounds memory use to `depth` batches.
+*
+* The pipeline only hands out slot and sequence numbers; the caller's
+* context owns one set of buffers per slot. The reader and writer use
+* plain blocking I/O, so files, pipes and terminals all work. If the
+* threads cannot be started, the stages run one after the other on the
+* calling thread.
+*
+* Dependencies:
+* stdint.h
+* pthread.h
+*****************************************************************************/
+#include <stdint.h>
+#include <pthread.h>
+
+// One slot per stage: a batch being read, one being processed and one being written
+#define IO_PIPELINE_DEPTH 3
+
+/*****************************************************************************
+**
+* Function type: IoStageFn
+*
+* Purpose:
+* Runs one stage on batch number `sequence`, held in slot
+* `sequence % depth`. The read stage returns 1 once it has filled the slot,
+* 0 at the end of the input (the slot stays empty), or a negative value
+* on error. The process and write stages return 0, or a negative value on
+* error. Any error stops every stage after its current call.
+*****************************************************************************/
+typedef int (*IoStageFn)(void *context, int slot, uint64_t sequence);
+
+/*****************************************************************************
+**
+* Structure: IoPipeline
+*
+* Fields:
+* lock (pthread_mutex_t) - Protects every field below.
+* changed (pthread_cond_t) - Broadcast whenever a stage finishes a batch, ends or fails.
+* depth (int) - Slots in the ring.
+* read, processed, written (uint64_t) - Batches each stage has finished.
+* inputEnded (int) - Set when the read stage reports the end of the input.
+* processEnded (int) - Set when the process stage has no batches left.
+* failed (int) - The negative result of the first stage to fail, or 0.
+* readFn, processFn, writeFn (IoStageFn) - The stages.
+* context (void*) - Passed to every stage.
+*****************************************************************************/
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    int depth;
+    uint64_t read;
+    uint64_t processed;
+    uint64_t written;
+    int inputEnded;
+    int processEnded;
+    int failed;
+    IoStageFn readFn;
+    IoStageFn processFn;
+    IoStageFn writeFn;
+    void *context;
+} IoPipeline;
+
+/*****************************************************************************
+**
+* Function: ioPipelineRun
+*
+* Purpose:
+* Runs batches 0, 1, ... through the three stages until the read stage
+* reports the end of the input, and returns once every batch read has
+* been processed and written (or a stage has failed). `depth` is at least
+* 1; a depth of 1 runs the stages in lock step.
+*
+* Returns:
+* int - 0 if every batch went through every stage, or the negative result of the first stage that failed.
+*****************************************************************************/
+int ioPipelineRun(int depth, IoStageFn read, IoStageFn process, IoStageFn write, void *context);
+
+#endif //IO_PIPELINE_H
@@ -0,0 +1,527 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "compress_and_decompress.h"
+#include "file_input.h"
+#include "huf_check.h"
+#include "huf_error.h"
+#include "huf_parallel.h"
+#include "huf_stats.h"
+
+/*****************************************************************************
+**
+* Filename: main.c
+*
+* Description:
+* Command-line driver. `-c` and `-d` compress and decompress with the
+* block stream format (huf_stream.h), on several threads when `-t` asks
+* for them (huf_parallel.h), and with reading and writing overlapped with
+* the coding either way; either file may be "-" or left out for standard
+* input/output. `bench` runs one input through every stage of
+* compress()/decompress() and through the block stream, and reports the
+* throughput of each stage, the compression ratios and the peak RSS, so
+* runs before and after a change are measured the same way. `-v` prints
+* the per-stage statistics of huf_stats.h to standard error (build with
+* -DHUF_STATS to collect them). `-1` lets the encoder code blocks with
+* order-1 context tables (context_model.h) where they come out smaller.
+* `-s` lets each block reuse the previous block's code table, coding it in
+* a single pass (block_codec.h); the blocks are then coded on one thread.
+* `check` runs the self-checks of huf_check.h: round trips of generated
+* and corrupted inputs through every encoder and decoder, then the
+* throughput of each mode on the input (or a generated one), recorded to
+* a baseline file with `-w` or held to one with `-g`. The library returns
+* every failure as a HufError, and only this driver prints it.
+*
+* Dependencies:
+* stdio.h
+* stdlib.h
+* string.h
+* time.h
+* unistd.h
+* sys/resource.h
+* compress_and_decompress.h
+* file_input.h
+* huf_check.h
+* huf_error.h
+* huf_parallel.h
+* huf_stats.h
+*
+* Compilation:
+* gcc -O2 -pthread compress_and_decompress.c priority_queue.c histogram.c file_input.c bit_io.c decode_table.c canonical.c huffman_arena.c crc32c.c block_codec.c context_model.c huf_stream.c huf_archive.c huf_context.c huf_error.c huf_dict.c huf_stats.c thread_pool.c io_pipeline.c huf_parallel.c huf_check.c main.c -o huf -lm
+*
+* Usage:
+* ./huf -c [-v] [-1] [-s] [-b blockSize] [-t threads] [input [output]]
+* ./huf -d [-v] [-t threads] [input [output]]
+* ./huf bench [-v] [-1] [-s] [-b blockSize] [-t threads] [-r repetitions] [input]
+* ./huf check [-n rounds] [-r repetitions] [-g baseline | -w baseline] [input]
+*****************************************************************************/
+
+#define CLI_DEFAULT_REPETITIONS 3
+#define CLI_DEFAULT_ROUNDS 200
+
+static void usage(void) {
+    fprintf(stderr,
+            "Usage: huf -c [-v] [-1] [-s] [-b blockSize] [-t threads] [input [output]]\n"
+            "       huf -d [-v] [-t threads] [input [output]]\n"
+            "       huf bench [-v] [-1] [-s] [-b blockSize] [-t threads] [-r repetitions] [input]\n"
+            "       huf check [-n rounds] [-r repetitions] [-g baseline | -w baseline] [input]\n"
+            "Files default to standard input/output (\"-\"). blockSize accepts a K or M suffix\n"
+            "(default %zuK, at most %zuM); threads defaults to 1. -1 tries order-1 context\n"
+            "tables per block. -s reuses the previous block's table where a new one would\n"
+            "not pay for its header, and compresses on one thread. check round-trips %d\n"
+            "generated and corrupted inputs by default, then times each mode against the\n"
+            "baseline of -g (failing below %.0f%% of it), or records one with -w.\n",
+            HUF_DEFAULT_BLOCK_SIZE >> 10, HUF_MAX_BLOCK_SIZE >> 20, CLI_DEFAULT_ROUNDS, HUF_CHECK_TOLERANCE * 100);
+}
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Parses a block size such as 65536, 64K or 1M. Returns 0 for a malformed or out-of-range size.
+static size_t parseSize(const char *text) {
+    char *end;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (*end == 'K' || *end == 'k') {
+        value <<= 10;
+        end++;
+    } else if (*end == 'M' || *end == 'm') {
+        value <<= 20;
+        end++;
+    }
+    return *end == '\0' && value > 0 && value <= HUF_MAX_BLOCK_SIZE ? (size_t)value : 0;
+}
+
+/*****************************************************************************
+**
+* Structure: CliOptions
+*
+* Fields:
+* blockSize (size_t) - Input bytes per block; 0 selects HUF_DEFAULT_BLOCK_SIZE.
+* threads (int) - Threads for compression and decompression, including the main thread.
+* contextOrder (int) - Set to 1 by -1: passed to the encoder (see context_model.h).
+* reuseTables (int) - Set by -s: the single-threaded encoder may reuse the previous block's table.
+* repetitions (int) - Timed runs per bench stage; the fastest is reported.
+* rounds (int) - Generated inputs for check.
+* baseline (const char*) - Throughput baseline for check, or NULL.
+* recordBaseline (int) - Set by -w: check writes `baseline` instead of comparing against it.
+* stats (int) - Set by -v: collect and print HufStats.
+* input (const char*) - Input file, or "-" for standard input.
+* output (const char*) - Output file, or "-" for standard output.
+*****************************************************************************/
+typedef struct {
+    size_t blockSize;
+    int threads;
+    int contextOrder;
+    int reuseTables;
+    int repetitions;
+    int rounds;
+    const char *baseline;
+    int recordBaseline;
+    int stats;
+    const char *input;
+    const char *output;
+} CliOptions;
+
+// Reads the options after the mode argument. Returns 0, or -1 after printing the usage.
+static int parseOptions(int argc, char *argv[], CliOptions *options) {
+    options->blockSize = 0;
+    options->threads = 1;
+    options->contextOrder = 0;
+    options->reuseTables = 0;
+    options->repetitions = CLI_DEFAULT_REPETITIONS;
+    options->rounds = CLI_DEFAULT_ROUNDS;
+    options->baseline = NULL;
+    options->recordBaseline = 0;
+    options->stats = 0;
+    options->input = "-";
+    options->output = "-";
+    int files = 0;
+    for (int i = 0; i < argc; i++) {
+        const char *arg = argv[i];
+        if ((strcmp(arg, "-g") == 0 || strcmp(arg, "-w") == 0) && i + 1 < argc) {
+            options->baseline = argv[++i];
+            options->recordBaseline = arg[1] == 'w';
+        } else if ((strcmp(arg, "-b") == 0 || strcmp(arg, "-t") == 0 || strcmp(arg, "-r") == 0 ||
+                    strcmp(arg, "-n") == 0) && i + 1 < argc) {
+            const char *value = argv[++i];
+            if (arg[1] == 'b') {
+                options->blockSize = parseSize(value);
+                if (options->blockSize == 0) {
+                    fprintf(stderr, "Error: Invalid block size '%s'\n", value);
+                    return -1;
+                }
+            } else if (arg[1] == 't') {
+                options->threads = atoi(value);
+            } else if (arg[1] == 'n') {
+                options->rounds = atoi(value);
+            } else {
+                options->repetitions = atoi(value);
+            }
+            if (options->threads < 1 || options->repetitions < 1 || options->rounds < 0) {
+                fprintf(stderr, "Error: Invalid count '%s'\n", value);
+                return -1;
+            }
+        } else if (strcmp(arg, "-v") == 0) {
+            options->stats = 1;
+        } else if (strcmp(arg, "-1") == 0) {
+            options->contextOrder = 1;
+        } else if (strcmp(arg, "-s") == 0) {
+            options->reuseTables = 1;
+        } else if (arg[0] == '-' && arg[1] != '\0') {
+            usage();
+            return -1;
+        } else if (files == 0) {
+            options->input = arg;
+            files++;
+        } else if (files == 1) {
+            options->output = arg;
+            files++;
+        } else {
+            usage();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Opens `name` for binary reading or writing; "-" is standard input or output
+static FILE *openFile(const char *name, const char *mode) {
+    if (strcmp(name, "-") == 0) {
+        return mode[0] == 'r' ? stdin : stdout;
+    }
+    FILE *file = fopen(name, mode);
+    if (file == NULL) {
+        fprintf(stderr, "Error: Unable to open file '%s'\n", name);
+    }
+    return file;
+}
+
+// Prints a library failure; returns -1 for it, or 0 for HUF_OK
+static int reportError(HufError error) {
+    if (error == HUF_OK) {
+        return 0;
+    }
+    fprintf(stderr, "Error: %s\n", hufErrorString(error));
+    return -1;
+}
+
+// Opens an input with openInputFile(), printing the failure
+static int openInput(InputFile *input, const char *name) {
+    HufError error = openInputFile(input, name);
+    if (error != HUF_OK) {
+        fprintf(stderr, "Error: %s '%s'\n", hufErrorString(error), name);
+        return -1;
+    }
+    return 0;
+}
+
+static void printStats(const HufStats *stats) {
+    if (!hufStatsEnabled()) {
+        fprintf(stderr, "Statistics are compiled out; rebuild with -DHUF_STATS\n");
+        return;
+    }
+    fflush(stdout); // Keep the bench report and the statistics in order on a terminal
+    hufStatsPrint(stats, stderr);
+}
+
+static int runCodec(const CliOptions *options, int decompressing) {
+    if (!decompressing && strcmp(options->output, "-") == 0 && isatty(STDOUT_FILENO)) {
+        fprintf(stderr, "Error: Refusing to write compressed data to a terminal\n");
+        return -1;
+    }
+    FILE *in = openFile(options->input, "rb");
+    if (in == NULL) {
+        return -1;
+    }
+    FILE *out = openFile(options->output, "wb");
+    if (out == NULL) {
+        if (in != stdin) {
+            fclose(in);
+        }
+        return -1;
+    }
+
+    HufStats stats;
+    hufStatsReset(&stats);
+    if (options->stats) {
+        hufStatsAttach(&stats);
+    }
+    HufError error;
+    if (decompressing) {
+        error = hufDecompressParallel(in, out, options->threads);
+    } else {
+        error = hufCompressParallel(in, out, options->blockSize, options->contextOrder, options->reuseTables, options->threads);
+    }
+    int status = reportError(error);
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (fflush(out) != 0 || (out != stdout && fclose(out) != 0)) {
+        fprintf(stderr, "Error: Unable to write output\n");
+        status = -1;
+    }
+    if (options->stats) {
+        hufStatsAttach(NULL);
+        printStats(&stats);
+    }
+    return status;
+}
+
+static void reportStage(const char *stage, size_t bytes, double seconds) {
+    printf("%-16s %10.1f MB/s %10.3f ms\n", stage, seconds > 0 ? (double)bytes / seconds / 1e6 : 0.0, seconds * 1e3);
+}
+
+static void keepFastest(double *best, double start, int rep) {
+    double elapsed = nowSeconds() - start;
+    if (rep == 0 || elapsed < *best) {
+        *best = elapsed;
+    }
+}
+
+// Times countBufferFrequencies -> tree build and codes -> compressBuffer -> decompress on the input in memory
+static int benchStages(const CliOptions *options, const InputFile *input) {
+    node_t nodes[256];
+    int uniqueCount = 0;
+    double histogramTime = 0;
+    double treeTime = 0;
+    double encodeTime = 0;
+    double decodeTime = 0;
+    static char codes[256][MAX];
+    HuffmanNode *root = NULL;
+
+    for (int rep = 0; rep < options->repetitions; rep++) {
+        double start = nowSeconds();
+        countBufferFrequencies(input->data, input->size, nodes, &uniqueCount);
+        keepFastest(&histogramTime, start, rep);
+    }
+    for (int rep = 0; rep < options->repetitions; rep++) {
+        freeHuffmanTree(root);
+        double start = nowSeconds();
+        MinHeap heap;
+        if (initHeap(&heap, uniqueCount) != 0) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            return -1;
+        }
+        for (int i = 0; i < uniqueCount; i++) {
+            HuffmanNode *leaf = createLeafNode((char)nodes[i].index, nodes[i].weight);
+            if (leaf == NULL) {
+                while (heap.size > 0) {
+                    freeHuffmanTree(heapPop(&heap));
+                }
+                break;
+            }
+            heapPush(&heap, leaf); // Cannot fail: the heap holds uniqueCount nodes
+        }
+        root = heap.size == uniqueCount ? buildHuffmanTreeHeap(&heap) : NULL;
+        freeHeap(&heap);
+        if (root == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            return -1;
+        }
+        HuffmanCodes(root, codes);
+        keepFastest(&treeTime, start, rep);
+    }
+
+    size_t longest = 1;
+    for (int i = 0; i < 256; i++) {
+        size_t length = strlen(codes[i]);
+        longest = length > longest ? length : longest;
+    }
+    unsigned char *compressed = malloc(input->size * longest / 8 + 8);
+    char *decompressed = malloc(input->size + 1);
+    if (compressed == NULL || decompressed == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        free(compressed);
+        free(decompressed);
+        freeHuffmanTree(root);
+        return -1;
+    }
+    uint64_t bits = 0;
+    size_t decoded = 0;
+    for (int rep = 0; rep < options->repetitions; rep++) {
+        double start = nowSeconds();
+        bits = compressBuffer(input->data, input->size, compressed, codes);
+        keepFastest(&encodeTime, start, rep);
+    }
+    for (int rep = 0; rep < options->repetitions; rep++) {
+        double start = nowSeconds();
+        decoded = decompress(compressed, bits, decompressed, input->size + 1, root);
+        keepFastest(&decodeTime, start, rep);
+    }
+    int ok = decoded == input->size && memcmp(decompressed, input->data, input->size) == 0;
+
+    printf("compress()/decompress(), %d distinct bytes:\n", uniqueCount);
+    reportStage("  histogram", input->size, histogramTime);
+    reportStage("  tree + codes", input->size, treeTime);
+    reportStage("  encode", input->size, encodeTime);
+    reportStage("  decode", input->size, decodeTime);
+    printf("  ratio            %10.3f (%llu bytes, %.3f bits/byte)%s\n",
+           (double)((bits + 7) / 8) / (double)input->size, (unsigned long long)((bits + 7) / 8),
+           (double)bits / (double)input->size, ok ? "" : " MISMATCH");
+
+    free(compressed);
+    free(decompressed);
+    freeHuffmanTree(root);
+    return ok ? 0 : -1;
+}
+
+// Times the block stream (with --threads workers, or coding on one thread for -s) from memory to a temporary file and back
+static int benchStream(const CliOptions *options, const InputFile *input) {
+    double encodeTime = 0;
+    double decodeTime = 0;
+    long compressedSize = 0;
+    FILE *compressed = tmpfile();
+    FILE *sink = fopen("/dev/null", "wb");
+    if (compressed == NULL || sink == NULL) {
+        fprintf(stderr, "Error: Unable to create temporary files\n");
+        if (compressed != NULL) {
+            fclose(compressed);
+        }
+        if (sink != NULL) {
+            fclose(sink);
+        }
+        return -1;
+    }
+
+    int status = 0;
+    for (int rep = 0; status == 0 && rep < options->repetitions; rep++) {
+        FILE *in = fmemopen((void *)input->data, input->size, "rb");
+        if (in == NULL || ftruncate(fileno(compressed), 0) != 0) {
+            status = -1;
+            break;
+        }
+        rewind(compressed);
+        double start = nowSeconds();
+        status = reportError(hufCompressParallel(in, compressed, options->blockSize, options->contextOrder,
+                                                 options->reuseTables, options->threads));
+        fflush(compressed);
+        keepFastest(&encodeTime, start, rep);
+        fclose(in);
+        compressedSize = ftell(compressed);
+    }
+    for (int rep = 0; status == 0 && rep < options->repetitions; rep++) {
+        rewind(compressed);
+        double start = nowSeconds();
+        status = reportError(hufDecompressParallel(compressed, sink, options->threads));
+        fflush(sink);
+        keepFastest(&decodeTime, start, rep);
+    }
+
+    // One untimed decode into memory checks the round trip
+    char *roundTrip = NULL;
+    size_t roundTripSize = 0;
+    FILE *check = status == 0 ? open_memstream(&roundTrip, &roundTripSize) : NULL;
+    if (check != NULL) {
+        rewind(compressed);
+        status = reportError(hufDecompressParallel(compressed, check, options->threads));
+        fclose(check);
+        if (status == 0 && (roundTripSize != input->size || memcmp(roundTrip, input->data, input->size) != 0)) {
+            status = -1;
+        }
+    }
+    free(roundTrip);
+    fclose(compressed);
+    fclose(sink);
+
+    size_t blockSize = options->blockSize ? options->blockSize : HUF_DEFAULT_BLOCK_SIZE;
+    printf("block stream, %zuK blocks, %d thread%s:\n", blockSize >> 10, options->threads, options->threads > 1 ? "s" : "");
+    reportStage("  compress", input->size, encodeTime);
+    reportStage("  decompress", input->size, decodeTime);
+    printf("  ratio            %10.3f (%ld bytes)%s\n", input->size ? (double)compressedSize / (double)input->size : 0.0,
+           compressedSize, status == 0 ? "" : " MISMATCH");
+    return status;
+}
+
+static int runBench(const CliOptions *options) {
+    InputFile input;
+    if (openInput(&input, options->input) != 0) {
+        return -1;
+    }
+    if (input.size == 0) {
+        fprintf(stderr, "Error: Nothing to benchmark in '%s'\n", options->input);
+        closeInputFile(&input);
+        return -1;
+    }
+    printf("input: %s, %zu bytes, best of %d runs\n", options->input, input.size, options->repetitions);
+    // With -v, each section's statistics add up every repetition
+    HufStats stats;
+    hufStatsReset(&stats);
+    hufStatsAttach(options->stats ? &stats : NULL);
+    int status = benchStages(options, &input);
+    if (options->stats) {
+        printStats(&stats);
+        hufStatsReset(&stats);
+    }
+    if (benchStream(options, &input) != 0) {
+        status = -1;
+    }
+    hufStatsAttach(NULL);
+    if (options->stats) {
+        printStats(&stats);
+    }
+    closeInputFile(&input);
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        printf("peak RSS         %10.1f MB\n", (double)usage.ru_maxrss / 1024.0); // ru_maxrss is in KiB on Linux
+    }
+    return status;
+}
+
+// Self-checks on generated inputs (and the input, if one is given), then the throughput guard
+static int runCheck(const CliOptions *options) {
+    InputFile input = {0};
+    int fromFile = strcmp(options->input, "-") != 0;
+    if (fromFile && openInput(&input, options->input) != 0) {
+        return -1;
+    }
+    if (fromFile && input.size == 0) {
+        fprintf(stderr, "Error: Nothing to check in '%s'\n", options->input);
+        closeInputFile(&input);
+        return -1;
+    }
+    int status = hufCheckCorpus(options->rounds, 1);
+    if (fromFile && hufCheckRoundTrip(input.data, input.size) != 0) {
+        status = -1;
+    }
+    if (hufCheckThroughput(fromFile ? input.data : NULL, input.size, options->repetitions, options->baseline,
+                           options->recordBaseline) != 0) {
+        status = -1;
+    }
+    if (fromFile) {
+        closeInputFile(&input);
+    }
+    printf("check %s\n", status == 0 ? "passed" : "FAILED");
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    CliOptions options;
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+    if (parseOptions(argc - 2, argv + 2, &options) != 0) {
+        return 1;
+    }
+    if (strcmp(argv[1], "-c") == 0) {
+        return runCodec(&options, 0) == 0 ? 0 : 1;
+    }
+    if (strcmp(argv[1], "-d") == 0) {
+        return runCodec(&options, 1) == 0 ? 0 : 1;
+    }
+    if (strcmp(argv[1], "bench") == 0) {
+        return runBench(&options) == 0 ? 0 : 1;
+    }
+    if (strcmp(argv[1], "check") == 0) {
+        return runCheck(&options) == 0 ? 0 : 1;
+    }
+    usage();
+    return 1;
+}
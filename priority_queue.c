@@ -1,145 +1,224 @@
-
-#include "compress_and_decompress.h"
-#include <stdio.h>
-#include <stdlib.h>
-
-/*****************************************************************************
-**
-* Filename: priority_queue.c
-* Author: Amelia Korble
-* Student ID: 251 336 169
-* Version: 3
-* Date Created: Nov 25
-* Last Modified: Nov 28
-*
-* Description:
-* The countFrequencies function reads an input file, counts the occurrences of each character, and stores these frequencies in an array of node_t structures. Each node_t structure holds the ASCII value of the character (index) and its frequency (weight).
-It updates the count of unique characters in the file and returns it
-*priorityEnqueue inserts a new node into the queue in sorted order, ensuring that nodes are ordered by their frequency, with the smallest frequency node at the front of the queue
-*priorityDequeue removes and returns the node_t from the front of the queue. The node with the smallest weight (highest priority) is dequeued first. If the queue is empty, the function will exit
-*The initQueue and freeQueue functions do basic memory management (initialize and free the queue memory)
-* Dependencies:
-* stdio.h
-*stdlib.h
-*#include "compress_and_decompress.h"
-*
-*
-* Compilation:
-* gcc compress_and_decompress.c priority_queue.c ptest.c write_to_files.c -o 1
-* ./1 <FileName.txt> <CompressedFileName.huf>
-*****************************************************************************/
-void countFrequencies(const char *filename, node_t *nodes, int *uniqueCharCount) {
-    FILE *file = fopen(filename, "r");
-    if (file == NULL) {
-        fprintf(stderr, "Error: Unable to open file '%s'\n", filename);
-        exit(1);
-    }
-
-    // Initialize frequency array
-    int frequencies[256] = {0};
-
-    // Read characters and count occurrences
-    int c;
-    while ((c = fgetc(file)) != EOF) {
-        frequencies[c]++;
-    }
-
-    // Populate the nodes array with non-zero frequencies
-    int nodeIndex = 0;
-    for (int i = 0; i < 256; i++) {
-        if (frequencies[i] > 0) {
-            nodes[nodeIndex].index = i;
-            nodes[nodeIndex].weight = frequencies[i];
-            nodeIndex++;
-        }
-    }
-
-    *uniqueCharCount = nodeIndex;
-    fclose(file);
-}
-
-// Updated priorityDequeue function with debugging
-HuffmanNode* priorityDequeue(Queue* q) {
-    if (q->front == NULL) {
-        fprintf(stderr, "Queue is empty! Cannot dequeue.\n");
-        return NULL;  // Return NULL if the queue is empty
-    }
-
-    // Store the data of the front node to return
-    QueueNode* temp = q->front;
-    HuffmanNode* dequeuedNode = temp->node;
-
-    // Move the front pointer to the next node
-    q->front = q->front->next;
-
-    // If the queue is now empty, set rear to NULL
-    if (q->front == NULL) {
-        q->rear = NULL;
-    }
-
-    // Free the memory of the dequeued node
-    free(temp);
-
-    return dequeuedNode;
-}
-
-
-
-// Updated priorityEnqueue function with debugging
-void priorityEnqueue(Queue* q, HuffmanNode* newNode) {
-    // Allocate memory for the new QueueNode
-    QueueNode* newQueueNode = (QueueNode*)malloc(sizeof(QueueNode));
-    if (!newQueueNode) {
-        fprintf(stderr, "Error: Memory allocation failed\n");
-        exit(1);  // Exit if memory allocation fails
-    }
-    newQueueNode->node = newNode;
-    newQueueNode->next = NULL;
-
-    // If the queue is empty, insert at the front
-    if (q->front == NULL) {
-        q->front = q->rear = newQueueNode;
-        return;
-    }
-
-    // If the new node has a smaller frequency than the front node, insert at the front
-    if (newNode->frequency < q->front->node->frequency) {
-        newQueueNode->next = q->front;
-        q->front = newQueueNode;
-        return;
-    }
-
-    // Traverse to find the correct insertion point (based on frequency)
-    QueueNode* current = q->front;
-    while (current->next != NULL && current->next->node->frequency <= newNode->frequency) {
-        current = current->next;
-    }
-
-    // Insert the new node
-    newQueueNode->next = current->next;
-    current->next = newQueueNode;
-
-    // If inserted at the end, update the rear pointer
-    if (newQueueNode->next == NULL) {
-        q->rear = newQueueNode;
-    }
-}
-
-
-void initQueue(Queue *q) {
-    q->front = NULL;// Front of the queue is set to NULL to indicate it's empty
-    q->rear = NULL;// Rear of the queue is set to NULL to indicate it's empty
-}
-void freeQueue(Queue* q){
-    QueueNode* current = q->front;// Start from the front of the queue
-    // Iterate through all nodes in the queue
-    while (current != NULL) {
-        QueueNode* temp = current;// Temporarily store the current node
-        current = current->next;// Move to the next node
-        free(temp);// Free the memory of the current node
-    }
-    // Reset the front and rear pointers of the queue to indicate it's empty
-    q->front = NULL;
-    q->rear = NULL;
-}
-
+
+#include "compress_and_decompress.h"
+#include "file_input.h"
+#include "histogram.h"
+#include "huf_stats.h"
+#include <stdlib.h>
+
+/*****************************************************************************
+**
+* Filename: priority_queue.c
+* Author: Amelia Korble
+* Student ID: 251 336 169
+* Version: 3
+* Date Created: Nov 25
+* Last Modified: Nov 28
+*
+* Description:
+* The countFrequencies function reads an input file, counts the occurrences of each character, and stores these frequencies in an array of node_t structures. Each node_t structure holds the ASCII value of the character (index) and its frequency (weight).
+It updates the count of unique characters in the file and returns it
+*priorityEnqueue inserts a new node into the queue in sorted order, ensuring that nodes are ordered by their frequency, with the smallest frequency node at the front of the queue
+*priorityDequeue removes and returns the node_t from the front of the queue. The node with the smallest weight (highest priority) is dequeued first. If the queue is empty, the function returns NULL
+*None of the functions exit the program or print: allocation and file errors are returned to the caller
+*The initQueue and freeQueue functions do basic memory management (initialize and free the queue memory)
+*initHeap, heapPush, heapPop and freeHeap implement the array-backed binary min-heap used to build trees over large alphabets in O(n log n)
+* Dependencies:
+*stdlib.h
+*#include "compress_and_decompress.h"
+*#include "file_input.h"
+*#include "histogram.h"
+*#include "huf_stats.h"
+*
+*
+* Compilation:
+* gcc -pthread compress_and_decompress.c priority_queue.c histogram.c file_input.c bit_io.c decode_table.c canonical.c huffman_arena.c crc32c.c block_codec.c context_model.c huf_stream.c huf_archive.c huf_context.c huf_error.c huf_dict.c huf_stats.c thread_pool.c io_pipeline.c huf_parallel.c huf_check.c main.c -o huf -lm
+* ./huf -c <FileName.txt> <CompressedFileName.huf>
+*****************************************************************************/
+// Populates the nodes array with the byte values that occur, in ascending order
+static void nodesFromCounts(const uint64_t frequencies[256], node_t *nodes, int *uniqueCharCount) {
+    int nodeIndex = 0;
+    for (int i = 0; i < 256; i++) {
+        if (frequencies[i] > 0) {
+            nodes[nodeIndex].index = i;
+            nodes[nodeIndex].weight = frequencies[i];
+            nodeIndex++;
+        }
+    }
+    *uniqueCharCount = nodeIndex;
+}
+
+int countFrequencies(const char *filename, node_t *nodes, int *uniqueCharCount) {
+    InputFile input;
+    *uniqueCharCount = 0;
+    if (openInputFile(&input, filename) != 0) {
+        return -1;
+    }
+
+    // The whole file is mapped (or read) once and counted with the histogram kernel
+    HUF_STATS_TIMER(start);
+    uint64_t frequencies[256] = {0};
+    countHistogram(input.data, input.size, frequencies);
+
+    nodesFromCounts(frequencies, nodes, uniqueCharCount);
+    HUF_STATS_STAGE(HUF_STAGE_HISTOGRAM, start);
+    closeInputFile(&input);
+    return 0;
+}
+
+void countBufferFrequencies(const unsigned char *data, size_t size, node_t *nodes, int *uniqueCharCount) {
+    HUF_STATS_TIMER(start);
+    uint64_t frequencies[256] = {0};
+    countHistogram(data, size, frequencies);
+    nodesFromCounts(frequencies, nodes, uniqueCharCount);
+    HUF_STATS_STAGE(HUF_STAGE_HISTOGRAM, start);
+}
+
+// Updated priorityDequeue function with debugging
+HuffmanNode* priorityDequeue(Queue* q) {
+    if (q->front == NULL) {
+        return NULL;  // Return NULL if the queue is empty
+    }
+
+    // Store the data of the front node to return
+    QueueNode* temp = q->front;
+    HuffmanNode* dequeuedNode = temp->node;
+
+    // Move the front pointer to the next node
+    q->front = q->front->next;
+
+    // If the queue is now empty, set rear to NULL
+    if (q->front == NULL) {
+        q->rear = NULL;
+    }
+
+    // Free the memory of the dequeued node
+    free(temp);
+
+    return dequeuedNode;
+}
+
+
+
+// Updated priorityEnqueue function with debugging
+int priorityEnqueue(Queue* q, HuffmanNode* newNode) {
+    // Allocate memory for the new QueueNode
+    QueueNode* newQueueNode = (QueueNode*)malloc(sizeof(QueueNode));
+    if (!newQueueNode) {
+        return -1;  // The queue is left unchanged
+    }
+    HUF_STATS_ADD(queueAllocations, 1);
+    newQueueNode->node = newNode;
+    newQueueNode->next = NULL;
+
+    // If the queue is empty, insert at the front
+    if (q->front == NULL) {
+        q->front = q->rear = newQueueNode;
+        return 0;
+    }
+
+    // If the new node has a smaller frequency than the front node, insert at the front
+    if (newNode->frequency < q->front->node->frequency) {
+        newQueueNode->next = q->front;
+        q->front = newQueueNode;
+        return 0;
+    }
+
+    // Traverse to find the correct insertion point (based on frequency)
+    QueueNode* current = q->front;
+    while (current->next != NULL && current->next->node->frequency <= newNode->frequency) {
+        current = current->next;
+    }
+
+    // Insert the new node
+    newQueueNode->next = current->next;
+    current->next = newQueueNode;
+
+    // If inserted at the end, update the rear pointer
+    if (newQueueNode->next == NULL) {
+        q->rear = newQueueNode;
+    }
+    return 0;
+}
+
+
+void initQueue(Queue *q) {
+    q->front = NULL;// Front of the queue is set to NULL to indicate it's empty
+    q->rear = NULL;// Rear of the queue is set to NULL to indicate it's empty
+}
+void freeQueue(Queue* q){
+    QueueNode* current = q->front;// Start from the front of the queue
+    // Iterate through all nodes in the queue
+    while (current != NULL) {
+        QueueNode* temp = current;// Temporarily store the current node
+        current = current->next;// Move to the next node
+        free(temp);// Free the memory of the current node
+    }
+    // Reset the front and rear pointers of the queue to indicate it's empty
+    q->front = NULL;
+    q->rear = NULL;
+}
+
+int initHeap(MinHeap *heap, int capacity) {
+    heap->size = 0;
+    heap->capacity = 0;
+    heap->nodes = (HuffmanNode**)malloc((size_t)(capacity > 0 ? capacity : 1) * sizeof(HuffmanNode*));
+    if (!heap->nodes) {
+        return -1;
+    }
+    heap->capacity = capacity;
+    return 0;
+}
+
+int heapPush(MinHeap *heap, HuffmanNode *node) {
+    if (heap->size == heap->capacity) {
+        return -1;
+    }
+
+    // Move larger parents down until the new node's slot is found
+    int i = heap->size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap->nodes[parent]->frequency <= node->frequency) {
+            break;
+        }
+        heap->nodes[i] = heap->nodes[parent];
+        i = parent;
+    }
+    heap->nodes[i] = node;
+    return 0;
+}
+
+HuffmanNode* heapPop(MinHeap *heap) {
+    if (heap->size == 0) {
+        return NULL;
+    }
+
+    HuffmanNode *smallest = heap->nodes[0];
+    HuffmanNode *last = heap->nodes[--heap->size];
+
+    // Sift the last node down from the root, pulling the smaller child up each level
+    int i = 0;
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= heap->size) {
+            break;
+        }
+        if (child + 1 < heap->size && heap->nodes[child + 1]->frequency < heap->nodes[child]->frequency) {
+            child++;
+        }
+        if (last->frequency <= heap->nodes[child]->frequency) {
+            break;
+        }
+        heap->nodes[i] = heap->nodes[child];
+        i = child;
+    }
+    heap->nodes[i] = last;
+    return smallest;
+}
+
+void freeHeap(MinHeap *heap) {
+    free(heap->nodes);// Only the array; the HuffmanNodes belong to the tree
+    heap->nodes = NULL;
+    heap->size = 0;
+    heap->capacity = 0;
+}
@@ -0,0 +1,117 @@
+#include <stdlib.h>
+#include "thread_pool.h"
+
+/*****************************************************************************
+**
+* Filename: thread_pool.c
+*
+* Description:
+* Worker loop and batch dispatch for the ThreadPool. Jobs are coarse (a
+* whole block each), so they are handed out one at a time under the lock.
+*
+* Dependencies:
+* stdlib.h
+* thread_pool.h
+*****************************************************************************/
+
+// Takes jobs from the current batch until none are left. Called and returns with the lock held.
+static void runJobs(ThreadPool *pool, int worker) {
+    while (pool->nextJob < pool->jobCount) {
+        int job = pool->nextJob++;
+        ThreadJobFn fn = pool->fn;
+        void *context = pool->context;
+        pthread_mutex_unlock(&pool->lock);
+        fn(context, job, worker);
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->jobsDone == pool->jobCount) {
+            pthread_cond_broadcast(&pool->done);
+        }
+    }
+}
+
+static void *workerMain(void *argument) {
+    ThreadPoolWorker *self = argument;
+    ThreadPool *pool = self->pool;
+    unsigned seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+        runJobs(pool, self->worker);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+HufError threadPoolInit(ThreadPool *pool, int threadCount) {
+    pool->threadCount = threadCount < 1 ? 1 : threadCount;
+    pool->fn = NULL;
+    pool->context = NULL;
+    pool->jobCount = 0;
+    pool->nextJob = 0;
+    pool->jobsDone = 0;
+    pool->generation = 0;
+    pool->shutdown = 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    int workerCount = pool->threadCount - 1;
+    pool->threads = malloc((size_t)(workerCount > 0 ? workerCount : 1) * sizeof(pthread_t));
+    pool->workers = malloc((size_t)(workerCount > 0 ? workerCount : 1) * sizeof(ThreadPoolWorker));
+    if (pool->threads == NULL || pool->workers == NULL) {
+        pool->threadCount = 1;
+        threadPoolFree(pool);
+        return HUF_ERROR_ALLOCATION;
+    }
+    for (int i = 0; i < workerCount; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].worker = i + 1;
+        if (pthread_create(&pool->threads[i], NULL, workerMain, &pool->workers[i]) != 0) {
+            pool->threadCount = i + 1; // Only join the threads that started
+            threadPoolFree(pool);
+            return HUF_ERROR_THREAD;
+        }
+    }
+    return HUF_OK;
+}
+
+void threadPoolRun(ThreadPool *pool, int jobCount, ThreadJobFn fn, void *context) {
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->context = context;
+    pool->jobCount = jobCount;
+    pool->nextJob = 0;
+    pool->jobsDone = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+
+    runJobs(pool, 0); // The caller works too instead of idling
+    while (pool->jobsDone < pool->jobCount) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void threadPoolFree(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->threadCount - 1; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    free(pool->threads);
+    free(pool->workers);
+    pool->threads = NULL;
+    pool->workers = NULL;
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+}
@@ -0,0 +1,87 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+/*****************************************************************************
+**
+* Filename: thread_pool.h
+*
+* Description:
+* A fixed pool of worker threads that runs batches of independent jobs.
+* threadPoolRun hands out job numbers 0..jobCount-1 to the workers and to
+* the calling thread, and returns once every job has finished. The threads
+* are created once and sleep between batches, so a pipeline can run one
+* batch per group of blocks without creating threads each time.
+*
+* Dependencies:
+* pthread.h
+* huf_error.h
+*****************************************************************************/
+#include <pthread.h>
+#include "huf_error.h"
+
+// One job of a batch. `worker` is 0 for the calling thread and 1..threadCount-1 for the pool threads,
+// so per-worker scratch memory can be indexed by it.
+typedef void (*ThreadJobFn)(void *context, int job, int worker);
+
+typedef struct ThreadPool ThreadPool;
+
+// Per-thread start argument: the pool and the worker number the thread passes to its jobs
+typedef struct {
+    ThreadPool *pool;
+    int worker;
+} ThreadPoolWorker;
+
+/*****************************************************************************
+**
+* Structure: ThreadPool
+*
+* Fields:
+* threads (pthread_t*) - The threadCount - 1 worker threads.
+* workers (ThreadPoolWorker*) - Start arguments for the worker threads.
+* threadCount (int) - Threads taking part in a batch, including the caller.
+* lock (pthread_mutex_t) - Protects every field below.
+* start (pthread_cond_t) - Signalled when a batch starts or the pool shuts down.
+* done (pthread_cond_t) - Signalled when the last job of a batch finishes.
+* fn (ThreadJobFn) - The current batch's job function.
+* context (void*) - Passed to `fn`.
+* jobCount (int) - Jobs in the current batch.
+* nextJob (int) - Next job number to hand out.
+* jobsDone (int) - Jobs finished in the current batch.
+* generation (unsigned) - Incremented for every batch, so sleeping workers can tell a new batch from a spurious wakeup.
+* shutdown (int) - Set by threadPoolFree to stop the workers.
+*****************************************************************************/
+struct ThreadPool {
+    pthread_t *threads;
+    ThreadPoolWorker *workers;
+    int threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    ThreadJobFn fn;
+    void *context;
+    int jobCount;
+    int nextJob;
+    int jobsDone;
+    unsigned generation;
+    int shutdown;
+};
+
+/*****************************************************************************
+**
+* Function: threadPoolInit
+*
+* Purpose:
+* Starts `threadCount - 1` worker threads (the caller is the last one). A
+* count below 1 is treated as 1, which runs every job on the caller.
+*
+* Returns:
+* HufError - HUF_OK, HUF_ERROR_ALLOCATION, or HUF_ERROR_THREAD if a worker thread cannot be started.
+*****************************************************************************/
+HufError threadPoolInit(ThreadPool *pool, int threadCount);
+
+// Runs jobs 0..jobCount-1 on the pool and the calling thread, returning when all have finished.
+void threadPoolRun(ThreadPool *pool, int jobCount, ThreadJobFn fn, void *context);
+
+// Stops and joins the worker threads and frees the pool.
+void threadPoolFree(ThreadPool *pool);
+
+#endif //THREAD_POOL_H